@@ -0,0 +1,91 @@
+#include "allocator.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+static thread_local SearchArena threadArena;
+static thread_local SearchArena* currentArena = nullptr;
+
+SearchArena::~SearchArena() {
+    for (const auto& chunk : chunks) ::operator delete(chunk.data);
+}
+
+SearchArena* SearchArena::current() {
+    return currentArena;
+}
+
+void* SearchArena::allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        if (chunkIndex == chunks.size()) {
+            size_t size = std::max(CHUNK_SIZE, bytes + alignment);
+            chunks.push_back({static_cast<char*>(::operator new(size)), size});
+        }
+        
+        Chunk& chunk = chunks[chunkIndex];
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+        if (start + bytes <= chunk.size) {
+            used += start + bytes - offset;
+            offset = start + bytes;
+            peak = std::max(peak, used);
+            return chunk.data + start;
+        }
+        
+        // The rest of this chunk stays unused until the arena is rewound
+        used += chunk.size - offset;
+        chunkIndex++;
+        offset = 0;
+    }
+}
+
+ArenaScope::ArenaScope() : arena(nullptr) {
+    if (currentArena) return;
+    arena = &threadArena;
+    arena->release(SearchArena::Mark{0, 0, 0});
+    currentArena = arena;
+}
+
+ArenaScope::~ArenaScope() {
+    if (!arena) return;
+    currentArena = nullptr;
+    arena->release(SearchArena::Mark{0, 0, 0});
+}
+
+#ifdef DEBUG
+// Debug builds count every heap allocation per thread, so that the search
+// can show it stays off the heap
+static thread_local unsigned long long heapAllocations = 0;
+
+void* operator new(size_t bytes) {
+    heapAllocations++;
+    if (void* block = std::malloc(bytes ? bytes : 1)) return block;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t bytes) {
+    return ::operator new(bytes);
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    std::free(block);
+}
+#endif
+
+AllocationStats threadAllocationStats() {
+    AllocationStats stats;
+#ifdef DEBUG
+    stats.heapAllocations = heapAllocations;
+#endif
+    stats.arenaPeakBytes = threadArena.peakBytes();
+    return stats;
+}
\ No newline at end of file
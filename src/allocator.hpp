@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Allocation counters of one thread. Heap allocations are only counted in
+// debug builds (make debug), which instrument the global operator new.
+struct AllocationStats {
+    unsigned long long heapAllocations;
+    size_t arenaPeakBytes;              // high-water mark of the search arena
+    
+    AllocationStats() : heapAllocations(0), arenaPeakBytes(0) {}
+};
+
+AllocationStats threadAllocationStats();
+
+// Bump allocator for memory that lives no longer than one search. Every
+// thread has its own; ArenaScope makes it current for the duration of a
+// search and rewinds it afterwards, and ArenaMark gives back everything a
+// subtree of the search allocated. Chunks are kept for the next search.
+class SearchArena {
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+    
+    std::vector<Chunk> chunks;
+    size_t chunkIndex;
+    size_t offset;
+    size_t used;                        // bytes in chunks before chunkIndex, plus offset
+    size_t peak;
+    
+public:
+    static constexpr size_t CHUNK_SIZE = 256 * 1024;
+    
+    struct Mark {
+        size_t chunkIndex;
+        size_t offset;
+        size_t used;
+    };
+    
+    SearchArena() : chunkIndex(0), offset(0), used(0), peak(0) {}
+    ~SearchArena();
+    SearchArena(const SearchArena&) = delete;
+    SearchArena& operator=(const SearchArena&) = delete;
+    
+    // The calling thread's arena while it runs a search, nullptr otherwise
+    static SearchArena* current();
+    
+    void* allocate(size_t bytes, size_t alignment);
+    Mark mark() const { return Mark{chunkIndex, offset, used}; }
+    void release(const Mark& m) {
+        chunkIndex = m.chunkIndex;
+        offset = m.offset;
+        used = m.used;
+    }
+    size_t peakBytes() const { return peak; }
+};
+
+// Makes this thread's arena current until the end of the scope. Nested
+// scopes share the outer one's arena.
+class ArenaScope {
+private:
+    SearchArena* arena;                 // nullptr for a nested scope
+    
+public:
+    ArenaScope();
+    ~ArenaScope();
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// Returns the current arena to where it stood at construction. Everything
+// allocated from the arena in between must be gone by then.
+class ArenaMark {
+private:
+    SearchArena* arena;
+    SearchArena::Mark position;
+    
+public:
+    ArenaMark() : arena(SearchArena::current()), position(arena ? arena->mark() : SearchArena::Mark{0, 0, 0}) {}
+    ~ArenaMark() {
+        if (arena) arena->release(position);
+    }
+    ArenaMark(const ArenaMark&) = delete;
+    ArenaMark& operator=(const ArenaMark&) = delete;
+};
+
+// Standard allocator drawing from the arena that was current when the
+// container was created, or from the heap outside a search. Arena memory is
+// never freed individually. Copies made during a search go to the arena even
+// when the original lives on the heap.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    
+    SearchArena* arena;
+    
+    ArenaAllocator() : arena(SearchArena::current()) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+    
+    T* allocate(size_t count) {
+        if (arena) return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+    void deallocate(T* block, size_t) {
+        if (!arena) ::operator delete(block);
+    }
+    
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+    
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "analysis.hpp"
+#include "notation.hpp"
+#include "binary_format.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+static std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) return value;
+    
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static std::string jsonString(const std::string& value) {
+    std::string escaped = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped + "\"";
+}
+
+static std::string pvString(const SearchLine& line) {
+    std::string pv;
+    for (const auto& move : line.pv) {
+        if (!pv.empty()) pv += ' ';
+        pv += moveToString(move);
+    }
+    return pv;
+}
+
+bool BatchAnalyzer::parseRecord(const std::string& line, Board& board, std::string& id) {
+    std::istringstream stream(line);
+    std::string fields[4];
+    for (auto& field : fields) {
+        if (!(stream >> field)) return false;
+    }
+    
+    std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+    
+    // A plain FEN carries the two move counters; an EPD record carries
+    // operations such as `bm Nf3; id "pos.1";` instead.
+    std::string rest;
+    std::getline(stream, rest);
+    std::istringstream counters(rest);
+    int halfmove, fullmove;
+    if (counters >> halfmove >> fullmove) {
+        fen += " " + std::to_string(halfmove) + " " + std::to_string(fullmove);
+    }
+    
+    id.clear();
+    size_t idPos = rest.find("id ");
+    while (idPos != std::string::npos && idPos > 0 && rest[idPos - 1] != ' ' && rest[idPos - 1] != ';') {
+        idPos = rest.find("id ", idPos + 1);
+    }
+    if (idPos != std::string::npos) {
+        size_t open = rest.find('"', idPos);
+        size_t close = (open == std::string::npos) ? open : rest.find('"', open + 1);
+        if (close != std::string::npos) {
+            id = rest.substr(open + 1, close - open - 1);
+        }
+    }
+    
+    return board.loadFEN(fen);
+}
+
+std::string BatchAnalyzer::analyzeRecord(unsigned long long index, const std::string& line,
+                                         AIPlayer& searcher, Board& board, AnalysisStats& stats) const {
+    std::string id, fen, bestMove, error;
+    SearchResult result;
+    
+    if (!parseRecord(line, board, id)) {
+        error = "invalid FEN";
+    } else {
+        fen = board.toFEN();
+        if (board.getLegalMoves(board.getCurrentPlayer()).empty()) {
+            error = board.isInCheck(board.getCurrentPlayer()) ? "checkmate" : "stalemate";
+        } else {
+            // Each record is searched from an empty hash table so that the
+            // output does not depend on which worker analyzed what before
+            searcher.clearHash();
+            SearchLimits limits(options.depth);
+            limits.multiPV = options.multiPV;
+            result = searcher.search(board, limits);
+            bestMove = moveToString(result.bestMove);
+        }
+    }
+    
+    stats.positions++;
+    stats.nodes += result.nodes;
+    if (!error.empty()) stats.failed++;
+    
+    // Binary output keeps only analyzable positions, as PackedPosition records
+    if (options.format == OutputFormat::BINARY) {
+        if (!error.empty()) return std::string();
+        PackedPosition packed = packPosition(board, result.score);
+        return std::string(reinterpret_cast<const char*>(&packed), sizeof(packed));
+    }
+    
+    std::ostringstream row;
+    if (options.format == OutputFormat::CSV && options.multiPV > 1) {
+        for (size_t k = 0; k < std::max<size_t>(1, result.lines.size()); k++) {
+            row << index << ',' << csvField(id) << ',' << csvField(fen.empty() ? line : fen) << ',' << k + 1 << ',';
+            if (error.empty()) {
+                const SearchLine& pvLine = result.lines[k];
+                row << moveToString(pvLine.pv[0]) << ',' << pvLine.score << ',' << pvLine.depth << ','
+                    << result.nodes << ',' << pvString(pvLine);
+            } else {
+                row << ",,,,";
+            }
+            row << ',' << csvField(error) << '\n';
+        }
+    } else if (options.format == OutputFormat::CSV) {
+        row << index << ',' << csvField(id) << ',' << csvField(fen.empty() ? line : fen) << ','
+            << bestMove << ',';
+        if (error.empty()) row << result.score << ',' << result.depth << ',' << result.nodes;
+        else row << ",,";
+        row << ',' << csvField(error) << '\n';
+    } else {
+        row << "{\"index\":" << index << ",\"id\":" << jsonString(id)
+            << ",\"fen\":" << jsonString(fen.empty() ? line : fen);
+        if (error.empty()) {
+            row << ",\"bestmove\":" << jsonString(bestMove) << ",\"score\":" << result.score
+                << ",\"depth\":" << result.depth << ",\"nodes\":" << result.nodes
+                << ",\"pv\":" << jsonString(pvString(result.lines[0]));
+            if (options.multiPV > 1) {
+                row << ",\"lines\":[";
+                for (size_t k = 0; k < result.lines.size(); k++) {
+                    row << (k ? "," : "") << "{\"score\":" << result.lines[k].score << ",\"depth\":"
+                        << result.lines[k].depth << ",\"pv\":" << jsonString(pvString(result.lines[k])) << "}";
+                }
+                row << "]";
+            }
+        } else {
+            row << ",\"error\":" << jsonString(error);
+        }
+        row << "}\n";
+    }
+    return row.str();
+}
+
+AnalysisStats BatchAnalyzer::run(std::istream& input, std::ostream& output) {
+    struct Job {
+        unsigned long long index;
+        std::string line;
+    };
+    
+    const int numThreads = std::max(1, options.threads);
+    // Results must leave in input order, so readers may only run ahead of the
+    // writer by a bounded window; one slow position then cannot make the
+    // reorder buffer grow without limit.
+    const unsigned long long window = static_cast<unsigned long long>(numThreads) * 64;
+    
+    std::mutex mutex;
+    std::condition_variable workAvailable, spaceAvailable;
+    std::deque<Job> queue;
+    std::map<unsigned long long, std::string> pending;
+    unsigned long long nextToWrite = 0;
+    bool inputDone = false;
+    
+    if (options.format == OutputFormat::CSV) {
+        output << (options.multiPV > 1 ? "index,id,fen,multipv,move,score,depth,nodes,pv,error\n"
+                                       : "index,id,fen,bestmove,score,depth,nodes,error\n");
+    } else if (options.format == OutputFormat::BINARY) {
+        writePositionFileHeader(output);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    std::vector<AnalysisStats> workerStats(numThreads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t]() {
+            Topology::bindThread(t, options.placement.binding);
+            AIPlayer searcher(Color::WHITE);
+            searcher.setHashSize(options.placement.hashMegabytes, options.placement.pages);
+            searcher.setDepth(options.depth);
+            searcher.setTablebase(options.tablebase);
+            Board board;
+            
+            while (true) {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    workAvailable.wait(lock, [&]() { return !queue.empty() || inputDone; });
+                    if (queue.empty()) return;
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                }
+                
+                std::string row = analyzeRecord(job.index, job.line, searcher, board, workerStats[t]);
+                
+                std::lock_guard<std::mutex> lock(mutex);
+                pending.emplace(job.index, std::move(row));
+                while (!pending.empty() && pending.begin()->first == nextToWrite) {
+                    output << pending.begin()->second;
+                    pending.erase(pending.begin());
+                    nextToWrite++;
+                }
+                spaceAvailable.notify_one();
+            }
+        });
+    }
+    
+    std::string line;
+    unsigned long long index = 0;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        spaceAvailable.wait(lock, [&]() { return index < nextToWrite + window; });
+        queue.push_back({index++, std::move(line)});
+        workAvailable.notify_one();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inputDone = true;
+    }
+    workAvailable.notify_all();
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    output.flush();
+    
+    AnalysisStats total;
+    for (const auto& stats : workerStats) {
+        total.positions += stats.positions;
+        total.failed += stats.failed;
+        total.nodes += stats.nodes;
+    }
+    total.timeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include "board.hpp"
+#include "player.hpp"
+#include "numa.hpp"
+#include <iostream>
+#include <string>
+#include <thread>
+
+enum class OutputFormat { CSV, JSONL, BINARY };
+
+struct AnalysisOptions {
+    int threads;
+    int depth;
+    int multiPV;                // lines per position; CSV then has one row per line
+    OutputFormat format;
+    TablebaseConfig tablebase;
+    PlacementConfig placement;
+    
+    AnalysisOptions() : threads(std::max(1u, std::thread::hardware_concurrency())),
+                        depth(3), multiPV(1), format(OutputFormat::CSV) {}
+};
+
+struct AnalysisStats {
+    unsigned long long positions;
+    unsigned long long failed;
+    unsigned long long nodes;
+    double timeSeconds;
+    
+    AnalysisStats() : positions(0), failed(0), nodes(0), timeSeconds(0) {}
+    double positionsPerSecond() const { return timeSeconds > 0 ? positions / timeSeconds : 0; }
+};
+
+// Annotates a stream of FEN/EPD records (one per line) with the engine's best
+// move. Positions are searched concurrently, each worker owning its own Board
+// and AIPlayer, and results are written in input order.
+class BatchAnalyzer {
+private:
+    AnalysisOptions options;
+    
+    std::string analyzeRecord(unsigned long long index, const std::string& line,
+                              AIPlayer& searcher, Board& board, AnalysisStats& stats) const;
+    
+public:
+    explicit BatchAnalyzer(const AnalysisOptions& opts) : options(opts) {}
+    
+    AnalysisStats run(std::istream& input, std::ostream& output);
+    
+    static bool parseRecord(const std::string& line, Board& board, std::string& id);
+};
\ No newline at end of file
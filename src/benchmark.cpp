@@ -1,8 +1,20 @@
 #include "board.hpp"
 #include "game.hpp"
 #include "player.hpp"
+#include "pgn.hpp"
+#include "match.hpp"
+#include "zobrist.hpp"
+#include "perf_counters.hpp"
+#include "transposition.hpp"
+#include "numa.hpp"
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <random>
+#include <string>
 #include <chrono>
+#include <thread>
 #include <iomanip>
 #include <vector>
 #include <cmath>
@@ -17,7 +29,31 @@ private:
         std::string position;
     };
     
+    // Hardware counters around each measured phase, with --counters
+    PerfCounters counters;
+    bool countersEnabled = false;
+    
+    void startCounters() {
+        if (countersEnabled) counters.start();
+    }
+    PerfSample stopCounters() {
+        return countersEnabled ? counters.stop() : PerfSample();
+    }
+    void printCounters(const PerfSample& sample, double units, const std::string& unit) {
+        std::string line = sample.format(units, unit);
+        if (!line.empty()) std::cout << "    " << line << "\n";
+    }
+    
 public:
+    void enableCounters() {
+        countersEnabled = counters.open();
+        if (!countersEnabled) {
+            std::cout << "Performance counters unavailable (" << counters.getError() << ")\n\n";
+        } else if (!counters.hasHardware()) {
+            std::cout << "Hardware counters unavailable (" << counters.getError() << "), software counters only\n\n";
+        }
+    }
+    
     // Perft function - counts leaf nodes at given depth
     unsigned long long perft(Board& board, int depth) {
         if (depth == 0) return 1ULL;
@@ -35,6 +71,56 @@ public:
         return nodes;
     }
     
+    // Same count, walking a single board with makeMove/undoMove instead of
+    // copying it at every node
+    unsigned long long perftMakeUndo(Board& board, int depth) {
+        if (depth == 0) return 1ULL;
+        
+        MoveList moves;
+        board.generateLegalMoves(board.getCurrentPlayer(), moves);
+        unsigned long long nodes = 0;
+        
+        for (const Move& move : moves) {
+            if (board.makeMove(move)) {
+                nodes += perftMakeUndo(board, depth - 1);
+                board.undoMove();
+            }
+        }
+        
+        return nodes;
+    }
+    
+    // Nodes of the tree below `board` to `depth` at which isPseudoLegal or
+    // isLegal disagrees with the generated moves on any of the 65536 packed
+    // codes, the undefined kinds 8-15 included
+    unsigned long long packedCodeMismatches(Board& board, int depth, unsigned long long& positions) {
+        Color side = board.getCurrentPlayer();
+        MoveList pseudo, legal;
+        board.generatePseudoLegalMoves(side, pseudo);
+        board.generateLegalMoves(side, legal);
+        std::vector<bool> isPseudo(1 << 16), isLegal(1 << 16);
+        for (const auto& move : pseudo) isPseudo[packMove(move)] = true;
+        for (const auto& move : legal) isLegal[packMove(move)] = true;
+        
+        unsigned long long mismatches = 0;
+        for (uint32_t code = 0; code < (1 << 16); code++) {
+            uint16_t packed = static_cast<uint16_t>(code);
+            if (board.isPseudoLegal(packed) != isPseudo[code] || board.isLegal(packed) != isLegal[code]) {
+                mismatches++;
+                break;
+            }
+        }
+        positions++;
+        if (depth == 0) return mismatches;
+        
+        for (const auto& move : legal) {
+            board.makeMove(move);
+            mismatches += packedCodeMismatches(board, depth - 1, positions);
+            board.undoMove();
+        }
+        return mismatches;
+    }
+    
     void runPerftTests() {
         std::cout << "🧪 PERFT TESTS - Move Generation Validation\n";
         std::cout << "==========================================\n\n";
@@ -51,9 +137,11 @@ public:
         bool allPassed = true;
         
         for (int depth = 1; depth <= 4; depth++) {
+            startCounters();
             auto start = std::chrono::high_resolution_clock::now();
             unsigned long long nodes = perft(board, depth);
             auto end = std::chrono::high_resolution_clock::now();
+            PerfSample sample = stopCounters();
             
             double timeMs = std::chrono::duration<double, std::milli>(end - start).count();
             double timeSec = timeMs / 1000.0;
@@ -71,6 +159,7 @@ public:
             if (!passed) {
                 std::cout << "    Expected: " << expectedNodes[depth-1] << "\n";
             }
+            printCounters(sample, nodes, "node");
             
             // Stop if depth 4 takes too long
             if (depth == 4 && timeSec > 30.0) {
@@ -79,6 +168,85 @@ public:
             }
         }
         
+        // Positions 2-5 of the standard perft suite exercise castling, en
+        // passant, promotions and underpromotions
+        struct PerftPosition {
+            const char* name;
+            const char* fen;
+            int depth;
+            unsigned long long expected;
+        };
+        const PerftPosition suite[] = {
+            {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862ULL},
+            {"Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 4, 43238ULL},
+            {"Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467ULL},
+            {"Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379ULL},
+        };
+        
+        std::cout << "\n📋 Standard Perft Suite\n";
+        for (const auto& position : suite) {
+            Board suiteBoard;
+            suiteBoard.loadFEN(position.fen);
+            startCounters();
+            unsigned long long nodes = perft(suiteBoard, position.depth);
+            PerfSample sample = stopCounters();
+            bool passed = nodes == position.expected;
+            allPassed &= passed;
+            std::cout << "  " << std::left << std::setw(11) << position.name << std::right << " depth "
+                      << position.depth << ": " << std::setw(10) << nodes << " nodes "
+                      << (passed ? "✅ PASS" : "❌ FAIL") << "\n";
+            if (!passed) {
+                std::cout << "    Expected: " << position.expected << "\n";
+            }
+            printCounters(sample, nodes, "node");
+        }
+        
+        // Undoing every move must restore the position exactly
+        std::cout << "\n📋 Make/Unmake Perft\n";
+        for (const auto& position : suite) {
+            Board suiteBoard;
+            suiteBoard.loadFEN(position.fen);
+            uint64_t key = suiteBoard.getKey();
+            
+            startCounters();
+            auto start = std::chrono::high_resolution_clock::now();
+            unsigned long long nodes = perftMakeUndo(suiteBoard, position.depth);
+            auto end = std::chrono::high_resolution_clock::now();
+            PerfSample sample = stopCounters();
+            double timeSec = std::chrono::duration<double>(end - start).count();
+            
+            bool passed = nodes == position.expected && suiteBoard.getKey() == key &&
+                          suiteBoard.toFEN() == position.fen;
+            allPassed &= passed;
+            std::cout << "  " << std::left << std::setw(11) << position.name << std::right << " depth "
+                      << position.depth << ": " << std::setw(10) << nodes << " nodes ("
+                      << std::fixed << std::setprecision(3) << timeSec << "s) "
+                      << (passed ? "✅ PASS" : "❌ FAIL") << "\n";
+            printCounters(sample, nodes, "node");
+        }
+        
+        // Single packed moves are validated without generating moves; every
+        // code must match the generators in every node of shallow trees
+        std::cout << "\n📋 Packed Move Validation\n";
+        for (const auto& position : suite) {
+            Board suiteBoard;
+            suiteBoard.loadFEN(position.fen);
+            unsigned long long positions = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            unsigned long long mismatches = packedCodeMismatches(suiteBoard, 2, positions);
+            double timeSec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            
+            bool passed = mismatches == 0;
+            allPassed &= passed;
+            std::cout << "  " << std::left << std::setw(11) << position.name << std::right << " depth 2: "
+                      << std::setw(10) << positions << " positions x 65536 codes ("
+                      << std::fixed << std::setprecision(3) << timeSec << "s) "
+                      << (passed ? "✅ PASS" : "❌ FAIL") << "\n";
+            if (!passed) {
+                std::cout << "    " << mismatches << " positions with a wrongly judged code\n";
+            }
+        }
+        
         std::cout << "\nResult: " << (allPassed ? "✅ ALL PASSED" : "❌ SOME FAILED") << "\n\n";
     }
     
@@ -103,7 +271,9 @@ public:
             auto start = std::chrono::high_resolution_clock::now();
             
             try {
+                startCounters();
                 Move bestMove = ai.getMove(board);
+                PerfSample sample = stopCounters();
                 
                 auto end = std::chrono::high_resolution_clock::now();
                 double timeMs = std::chrono::duration<double, std::milli>(end - start).count();
@@ -121,6 +291,7 @@ public:
                 
                 std::cout << std::fixed << std::setprecision(3) << timeSec << "s ("
                          << std::scientific << std::setprecision(2) << nps << " nps)\n";
+                printCounters(sample, 1, "move");
                 
                 // Make the move to test different positions
                 if (board.makeMove(bestMove)) {
@@ -145,80 +316,442 @@ public:
         return metrics;
     }
     
+    // Multi-PV cost relative to a single-PV search of the same depth; the
+    // shared hash table should keep it well below K times
+    void multiPVOverheadTest() {
+        std::cout << "🔀 MULTI-PV OVERHEAD\n";
+        std::cout << "===================\n\n";
+        
+        const std::vector<std::string> positions = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"
+        };
+        const int depth = 3;
+        double baseTime = 0;
+        unsigned long long baseNodes = 0;
+        
+        for (int lines : {1, 2, 4, 8}) {
+            double totalTime = 0;
+            unsigned long long totalNodes = 0;
+            PerfSample sample;
+            for (const auto& fen : positions) {
+                Board board;
+                board.loadFEN(fen);
+                AIPlayer ai(Color::WHITE);
+                SearchLimits limits(depth);
+                limits.multiPV = lines;
+                
+                startCounters();
+                auto start = std::chrono::high_resolution_clock::now();
+                SearchResult result = ai.search(board, limits);
+                totalTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+                sample += stopCounters();
+                totalNodes += result.nodes;
+            }
+            if (lines == 1) {
+                baseTime = totalTime;
+                baseNodes = totalNodes;
+            }
+            
+            std::cout << "  K=" << lines << ": " << std::setw(9) << totalNodes << " nodes, " << std::fixed
+                      << std::setprecision(3) << totalTime << "s, " << std::setprecision(2)
+                      << (baseTime > 0 ? totalTime / baseTime : 0) << "x time, "
+                      << (baseNodes > 0 ? static_cast<double>(totalNodes) / baseNodes : 0) << "x nodes (vs " << lines
+                      << "x for K separate searches)\n";
+            printCounters(sample, totalNodes, "node");
+        }
+        std::cout << "\n";
+    }
+    
     void gameStrengthTest() {
         std::cout << "🏆 GAME STRENGTH EVALUATION\n";
         std::cout << "===========================\n\n";
         
-        // Test different AI depths against each other
+        // Test different AI depths against each other: paired openings with
+        // colors swapped, Elo with a 95% confidence interval
         std::vector<std::pair<int, int>> matchups = {{2, 1}, {3, 1}, {3, 2}};
         
         for (const auto& matchup : matchups) {
-            int strongDepth = matchup.first;
-            int weakDepth = matchup.second;
+            MatchOptions options;
+            EngineConfig::parse("depth=" + std::to_string(matchup.first), options.first);
+            EngineConfig::parse("depth=" + std::to_string(matchup.second), options.second);
+            options.maxGames = 16;
+            options.useSprt = false;
+            options.reportInterval = 0;
             
-            std::cout << "🤖 AI Depth " << strongDepth << " vs Depth " << weakDepth << "\n";
-            
-            int wins = 0, draws = 0, losses = 0;
-            const int numGames = 3;
+            std::cout << "🤖 AI Depth " << matchup.first << " vs Depth " << matchup.second << "\n  ";
+            MatchRunner runner(options);
+            MatchStats stats = runner.run(std::cout);
+            MatchRunner::report(stats, options, std::cout);
+            std::cout << "\n";
+        }
+    }
+    
+    // Counts tokens without replaying them, isolating tokenizer throughput
+    class CountingVisitor : public PgnVisitor {
+    public:
+        unsigned long long moves = 0;
+        void move(std::string_view) override { moves++; }
+    };
+    
+    std::string generateRandomGames(int numGames, int maxPlies, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::ostringstream pgn;
+        PgnWriter writer(pgn);
+        
+        for (int g = 0; g < numGames; g++) {
+            Board board;
+            std::vector<Move> moves;
+            for (int ply = 0; ply < maxPlies; ply++) {
+                std::vector<Move> legalMoves = board.getLegalMoves(board.getCurrentPlayer());
+                if (legalMoves.empty()) break;
+                Move move = legalMoves[rng() % legalMoves.size()];
+                board.makeMove(move);
+                moves.push_back(move);
+            }
             
-            for (int game = 0; game < numGames; game++) {
-                Game chessGame;
-                chessGame.setPlayers(
-                    std::make_unique<AIPlayer>(Color::WHITE, strongDepth),
-                    std::make_unique<AIPlayer>(Color::BLACK, weakDepth)
-                );
-                
-                std::cout << "  Game " << (game + 1) << ": ";
-                
-                // Simulate game with reasonable move limit
-                int moveCount = 0;
-                const int maxMoves = 50;
-                
-                while (chessGame.getResult() == GameResult::ONGOING && moveCount < maxMoves) {
-                    Color currentColor = chessGame.getBoard().getCurrentPlayer();
-                    int currentDepth = (currentColor == Color::WHITE) ? strongDepth : weakDepth;
-                    
-                    try {
-                        AIPlayer currentAI(currentColor, currentDepth);
-                        Move move = currentAI.getMove(chessGame.getBoard());
-                        chessGame.playMove(move);
-                        moveCount++;
-                    } catch (...) {
-                        // If move generation fails, consider it a draw
-                        break;
-                    }
+            std::vector<std::pair<std::string, std::string>> tags = {
+                {"Event", "Random game " + std::to_string(g + 1)}, {"Site", "benchmark"},
+                {"Date", "????.??.??"}, {"Round", std::to_string(g + 1)},
+                {"White", "random"}, {"Black", "random"}
+            };
+            writer.writeGame(tags, Board(), moves, "*");
+        }
+        return pgn.str();
+    }
+    
+    void pgnThroughputTest(const std::string& path = "") {
+        std::cout << "📜 PGN THROUGHPUT\n";
+        std::cout << "================\n\n";
+        
+        std::string corpus;
+        if (path.empty()) {
+            std::string games = generateRandomGames(100, 120, 12345);
+            for (int copy = 0; copy < 100; copy++) corpus += games;
+            std::cout << "Corpus: 10000 random games (100 distinct), "
+                     << std::fixed << std::setprecision(1) << corpus.size() / 1e6 << " MB\n";
+        } else {
+            std::cout << "Corpus: " << path << "\n";
+        }
+        
+        CountingVisitor counter;
+        PgnReader tokenizer(counter);
+        if (path.empty()) {
+            tokenizer.readBuffer(corpus.data(), corpus.size());
+        } else if (!tokenizer.readFile(path)) {
+            std::cout << "Cannot open " << path << "\n\n";
+            return;
+        }
+        const PgnStats& tokenStats = tokenizer.getStats();
+        std::cout << "  Tokenize only:    " << std::fixed << std::setprecision(1)
+                 << tokenStats.megabytesPerSecond() << " MB/s, "
+                 << std::setprecision(0) << tokenStats.gamesPerSecond() << " games/s ("
+                 << counter.moves << " moves)\n";
+        
+        unsigned long long replayed = 0;
+        PgnReplayer replayer([&](const PgnGame& game) { replayed += game.moves.size(); });
+        PgnReader reader(replayer);
+        if (path.empty()) {
+            std::string sample = corpus.substr(0, corpus.size() / 100);
+            reader.readBuffer(sample.data(), sample.size());
+        } else {
+            reader.readFile(path);
+        }
+        const PgnStats& replayStats = reader.getStats();
+        std::cout << "  Tokenize + replay: " << std::fixed << std::setprecision(2)
+                 << replayStats.megabytesPerSecond() << " MB/s, "
+                 << std::setprecision(0) << replayStats.gamesPerSecond() << " games/s ("
+                 << replayed << " plies, " << replayer.getErrorCount() << " errors)\n\n";
+    }
+    
+    // Timings of one primitive: every repetition runs it over the whole
+    // corpus, enough times to take at least MIN_REPETITION_SECONDS
+    struct MicroResult {
+        std::string name;
+        unsigned long long opsPerRepetition;
+        std::vector<double> nsPerOp;
+        PerfSample counters;                // over all repetitions
+        unsigned long long totalOps = 0;
+        
+        double median() const {
+            std::vector<double> sorted = nsPerOp;
+            std::sort(sorted.begin(), sorted.end());
+            size_t mid = sorted.size() / 2;
+            return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+        }
+        double mean() const {
+            double sum = 0;
+            for (double value : nsPerOp) sum += value;
+            return nsPerOp.empty() ? 0 : sum / nsPerOp.size();
+        }
+        double variance() const {
+            if (nsPerOp.size() < 2) return 0;
+            double average = mean(), sum = 0;
+            for (double value : nsPerOp) sum += (value - average) * (value - average);
+            return sum / (nsPerOp.size() - 1);
+        }
+    };
+    
+    static constexpr int MICRO_REPETITIONS = 15;
+    static constexpr double MIN_REPETITION_SECONDS = 0.02;
+    
+    // `pass` runs the primitive once over the corpus and returns the number
+    // of operations; its results feed `sink` so that they are not optimized
+    // away. The first, calibrating passes double as the warm-up.
+    template <typename Pass>
+    MicroResult measure(const std::string& name, Pass pass) {
+        MicroResult result;
+        result.name = name;
+        
+        unsigned long long passes = 1;
+        while (true) {
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < passes; i++) pass();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (seconds >= MIN_REPETITION_SECONDS) break;
+            passes *= 2;
+        }
+        
+        startCounters();
+        for (int rep = 0; rep < MICRO_REPETITIONS; rep++) {
+            unsigned long long ops = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < passes; i++) ops += pass();
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            result.opsPerRepetition = ops;
+            result.nsPerOp.push_back(ops > 0 ? ns / ops : 0);
+            result.totalOps += ops;
+        }
+        result.counters = stopCounters();
+        return result;
+    }
+    
+    uint64_t sink = 0;
+    
+    // Times the board primitives one by one over a fixed set of positions
+    // and writes the results as JSON to `jsonPath` ("-" for stdout, empty
+    // for none)
+    void microBenchmarks(const std::string& jsonPath = "") {
+        std::cout << "🔬 MICRO-BENCHMARKS\n";
+        std::cout << "===================\n\n";
+        
+        const std::vector<std::string> fens = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+            "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+            "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+            "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"
+        };
+        std::vector<Board> boards(fens.size());
+        std::vector<std::vector<Move>> legalMoves;
+        for (size_t i = 0; i < fens.size(); i++) {
+            boards[i].loadFEN(fens[i]);
+            legalMoves.push_back(boards[i].getLegalMoves(boards[i].getCurrentPlayer()));
+        }
+        AIPlayer evaluator(Color::WHITE);
+        
+        std::vector<MicroResult> results;
+        results.push_back(measure("getLegalMoves", [&]() {
+            for (const auto& board : boards) sink += board.getLegalMoves(board.getCurrentPlayer()).size();
+            return static_cast<unsigned long long>(boards.size());
+        }));
+        results.push_back(measure("makeMove+undoMove", [&]() {
+            unsigned long long ops = 0;
+            for (size_t i = 0; i < boards.size(); i++) {
+                for (const auto& move : legalMoves[i]) {
+                    boards[i].makeMove(move);
+                    sink += boards[i].getKey();
+                    boards[i].undoMove();
+                    ops++;
                 }
-                
-                GameResult result = chessGame.getResult();
-                std::string resultStr;
-                
-                if (result == GameResult::WHITE_WINS) {
-                    wins++;
-                    resultStr = "Win";
-                } else if (result == GameResult::BLACK_WINS) {
-                    losses++;
-                    resultStr = "Loss";
-                } else {
-                    draws++;
-                    resultStr = "Draw";
+            }
+            return ops;
+        }));
+        results.push_back(measure("isSquareAttacked", [&]() {
+            for (const auto& board : boards) {
+                for (int square = 0; square < 64; square++) {
+                    Position pos(square / 8, square % 8);
+                    sink += board.isSquareAttacked(pos, Color::WHITE) + board.isSquareAttacked(pos, Color::BLACK);
                 }
-                
-                std::cout << resultStr << " (" << moveCount << " moves)\n";
             }
+            return static_cast<unsigned long long>(boards.size() * 128);
+        }));
+        results.push_back(measure("isInCheck", [&]() {
+            for (const auto& board : boards) sink += board.isInCheck(Color::WHITE) + board.isInCheck(Color::BLACK);
+            return static_cast<unsigned long long>(boards.size() * 2);
+        }));
+        results.push_back(measure("evaluate", [&]() {
+            for (const auto& board : boards) sink += evaluator.evaluate(board);
+            return static_cast<unsigned long long>(boards.size());
+        }));
+        results.push_back(measure("loadFEN", [&]() {
+            Board board;
+            for (const auto& fen : fens) {
+                board.loadFEN(fen);
+                sink += board.getKey();
+            }
+            return static_cast<unsigned long long>(fens.size());
+        }));
+        results.push_back(measure("Zobrist::hash", [&]() {
+            for (const auto& board : boards) sink += Zobrist::hash(board);
+            return static_cast<unsigned long long>(boards.size());
+        }));
+        results.push_back(measure("getKey", [&]() {
+            for (const auto& board : boards) sink += board.getKey();
+            return static_cast<unsigned long long>(boards.size());
+        }));
+        
+        std::cout << "  " << std::left << std::setw(20) << "primitive" << std::right << std::setw(12) << "median ns"
+                  << std::setw(12) << "mean ns" << std::setw(12) << "stddev" << std::setw(12) << "ops/rep" << "\n";
+        for (const auto& result : results) {
+            std::cout << "  " << std::left << std::setw(20) << result.name << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(12) << result.median() << std::setw(12) << result.mean()
+                      << std::setw(12) << std::sqrt(result.variance()) << std::setw(12) << result.opsPerRepetition
+                      << "\n";
+            printCounters(result.counters, result.totalOps, "op");
+        }
+        std::cout << "\n  " << fens.size() << " positions, " << MICRO_REPETITIONS << " repetitions (checksum "
+                  << (sink & 0xffff) << ")\n\n";
+        
+        if (jsonPath.empty()) return;
+        std::ofstream file;
+        if (jsonPath != "-") {
+            file.open(jsonPath);
+            if (!file) {
+                std::cout << "Cannot write " << jsonPath << "\n\n";
+                return;
+            }
+        }
+        std::ostream& out = jsonPath == "-" ? std::cout : file;
+        out << "{\"positions\":" << fens.size() << ",\"repetitions\":" << MICRO_REPETITIONS << ",\"benchmarks\":[";
+        for (size_t i = 0; i < results.size(); i++) {
+            const MicroResult& result = results[i];
+            out << (i ? "," : "") << "\n  {\"name\":\"" << result.name << "\",\"ops_per_repetition\":"
+                << result.opsPerRepetition << std::fixed << std::setprecision(2) << ",\"median_ns\":" << result.median()
+                << ",\"mean_ns\":" << result.mean() << ",\"variance_ns2\":" << result.variance() << ",\"samples_ns\":[";
+            for (size_t k = 0; k < result.nsPerOp.size(); k++) out << (k ? "," : "") << result.nsPerOp[k];
+            out << "],\"counters_per_op\":{";
+            bool first = true;
+            for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+                PerfEvent event = static_cast<PerfEvent>(e);
+                if (!result.counters.has(event)) continue;
+                out << (first ? "" : ",") << "\"" << PerfCounters::name(event) << "\":"
+                    << static_cast<double>(result.counters.get(event)) / std::max(1ULL, result.totalOps);
+                first = false;
+            }
+            out << "}}";
+        }
+        out << "\n]}\n";
+    }
+    
+    // Key of link `index` in the probe chain below
+    static uint64_t chainKey(uint64_t index) {
+        uint64_t x = index + 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+    
+    // Stores a chain of `length` entries at random slots, each holding the
+    // index of the next as its score
+    static void storeChain(TranspositionTable& tt, uint64_t length) {
+        for (uint64_t i = 0; i < length; i++) {
+            tt.store(chainKey(i), 1, static_cast<int>((i + 1) % length), Bound::EXACT, 0);
+        }
+    }
+    
+    // Follows the chain for `probes` probes from link `first`. Every probe
+    // needs the previous one's result, so the time per probe is the latency
+    // of a random access into the table. Links lost to collisions are
+    // skipped.
+    static uint64_t followChain(const TranspositionTable& tt, uint64_t length, uint64_t first, uint64_t probes) {
+        uint64_t link = first;
+        TTEntry entry;
+        for (uint64_t i = 0; i < probes; i++) {
+            link = tt.probe(chainKey(link), entry) ? static_cast<uint64_t>(entry.score) : (link + 1) % length;
+        }
+        return link;
+    }
+    
+    // Effect of the transposition table's page backing and of thread
+    // binding: time and page faults to first-touch a table of `megabytes`,
+    // then latency and TLB misses of random probes into it. The counters are
+    // opened for this test even without --counters.
+    void memoryPlacementTest(size_t megabytes) {
+        std::cout << "🧠 TRANSPOSITION TABLE MEMORY\n";
+        std::cout << "=============================\n\n";
+        
+        if (!countersEnabled) enableCounters();
+        int threads = static_cast<int>(Topology::allowedCpus().size());
+        std::cout << "  " << Topology::describe() << ", " << megabytes << " MB table\n\n";
+        
+        const uint64_t probes = 1 << 22;
+        auto report = [&](const std::string& label, double initMs, const PerfSample& initCounters,
+                          double probeNs, const PerfSample& probeCounters, const TranspositionTable& tt) {
+            std::cout << "  " << std::left << std::setw(26) << label << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(10) << initMs << " ms init" << std::setw(8) << probeNs
+                      << " ns/probe   " << pageModeName(tt.getPageMode()) << ", " << (tt.hugePageBytes() >> 20)
+                      << " MB in huge pages\n";
+            printCounters(initCounters, static_cast<double>(megabytes), "MB init");
+            printCounters(probeCounters, static_cast<double>(probes), "probe");
+        };
+        
+        // Page backing, one thread: initialized and probed by this thread
+        for (PageMode pages : {PageMode::SMALL, PageMode::TRANSPARENT, PageMode::EXPLICIT}) {
+            TranspositionTable tt(1, pages);
+            startCounters();
+            auto start = std::chrono::steady_clock::now();
+            tt.resize(megabytes, pages);
+            double initMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            PerfSample initCounters = stopCounters();
             
-            double score = (wins + 0.5 * draws) / numGames;
-            double winRate = score * 100;
+            uint64_t length = std::min<uint64_t>(tt.size() / 4, 1 << 21);
+            storeChain(tt, length);
+            startCounters();
+            start = std::chrono::steady_clock::now();
+            sink += followChain(tt, length, 0, probes);
+            double probeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                             / probes;
+            report(std::string("pages ") + pageModeName(pages), initMs, initCounters, probeNs, stopCounters(), tt);
+        }
+        
+        // Binding, all threads: first touch in parallel, then every thread
+        // probes its own part of the chain
+        for (ThreadBinding binding : {ThreadBinding::NONE, ThreadBinding::CORES, ThreadBinding::NODES}) {
+            TranspositionTable tt(1);
+            startCounters();
+            auto start = std::chrono::steady_clock::now();
+            tt.resize(megabytes, PageMode::TRANSPARENT, threads, binding);
+            double initMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            PerfSample initCounters = stopCounters();
             
-            // Rough Elo estimation: +400 Elo ≈ 90% score, +200 Elo ≈ 75% score
-            int eloDiff = 0;
-            if (score > 0.5) {
-                eloDiff = (int)(400 * log10(score / (1 - score)) / log10(10));
+            uint64_t length = std::min<uint64_t>(tt.size() / 4, 1 << 21);
+            storeChain(tt, length);
+            uint64_t perThread = probes / threads;
+            std::vector<double> seconds(threads);
+            std::vector<std::thread> workers;
+            startCounters();
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    Topology::bindThread(t, binding);
+                    auto begin = std::chrono::steady_clock::now();
+                    uint64_t last = followChain(tt, length, length * t / threads, perThread);
+                    seconds[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                    if (last == length) sink++;
+                });
             }
-            
-            std::cout << "  Results: " << wins << "W-" << draws << "D-" << losses << "L\n";
-            std::cout << "  Score: " << std::fixed << std::setprecision(1) << (score * 100) << "%\n";
-            std::cout << "  Est. Elo advantage: +" << eloDiff << "\n\n";
+            for (auto& worker : workers) worker.join();
+            PerfSample probeCounters = stopCounters();
+            double totalSeconds = 0;
+            for (double s : seconds) totalSeconds += s;
+            report(std::to_string(threads) + " threads, bind " + threadBindingName(binding), initMs, initCounters,
+                   totalSeconds * 1e9 / (perThread * threads), probeCounters, tt);
         }
+        std::cout << "\n";
     }
     
     void basicMoveValidation() {
@@ -268,13 +801,19 @@ public:
             searchResults.push_back(benchmarkAISearch(depth));
         }
         
-        // 4. Game strength evaluation
+        // 4. Multi-PV overhead
+        multiPVOverheadTest();
+        
+        // 5. Game strength evaluation
         gameStrengthTest();
         
+        // 6. PGN import/export throughput
+        pgnThroughputTest();
+        
         auto endTime = std::chrono::high_resolution_clock::now();
         double totalTime = std::chrono::duration<double>(endTime - startTime).count();
         
-        // 5. Final benchmark summary
+        // 7. Final benchmark summary
         std::cout << "📈 FINAL BENCHMARK RESULTS\n";
         std::cout << "=========================\n\n";
         
@@ -313,10 +852,49 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    ChessEngineBenchmark benchmark;
+    
+    // --counters (anywhere) adds hardware counter readings to every phase
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--counters") benchmark.enableCounters();
+        else args.push_back(argv[i]);
+    }
+    std::string mode = args.empty() ? "" : args[0];
+    
+    // ./benchmark pgn [file.pgn] runs only the PGN throughput section
+    if (mode == "pgn") {
+        benchmark.pgnThroughputTest(args.size() >= 2 ? args[1] : "");
+        return 0;
+    }
+    if (mode == "multipv") {
+        benchmark.multiPVOverheadTest();
+        return 0;
+    }
+    if (mode == "perft") {
+        benchmark.runPerftTests();
+        return 0;
+    }
+    // ./benchmark micro [file.json] times the board primitives, optionally
+    // writing JSON ("-" for stdout)
+    if (mode == "micro") {
+        benchmark.microBenchmarks(args.size() >= 2 ? args[1] : "");
+        return 0;
+    }
+    // ./benchmark memory [MB] compares page backings and thread bindings of
+    // a transposition table (default 256 MB)
+    if (mode == "memory") {
+        benchmark.memoryPlacementTest(args.size() >= 2 ? std::max(1, std::stoi(args[1])) : 256);
+        return 0;
+    }
+    if (mode == "strength") {
+        benchmark.gameStrengthTest();
+        return 0;
+    }
+    
     std::cout << "Starting Checkmate++ Chess Engine Benchmark...\n\n";
     
-    ChessEngineBenchmark benchmark;
     benchmark.runFullBenchmark();
     
     return 0;
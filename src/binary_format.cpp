@@ -0,0 +1,183 @@
+#include "binary_format.hpp"
+#include <algorithm>
+#include <cstring>
+
+static const char POSITION_MAGIC[8] = {'C', 'M', 'P', 'O', 'S', '0', '0', '1'};
+static const char GAME_MAGIC[8] = {'C', 'M', 'G', 'A', 'M', 'E', '0', '1'};
+
+PackedPosition packPosition(const Board& board, int score, GameResult result) {
+    PackedPosition packed;
+    std::memset(&packed, 0, sizeof(packed));
+    
+    int count = 0;
+    for (int square = 0; square < 64; square++) {
+        const Piece* piece = board.getPiece(Position(square / 8, square % 8));
+        if (!piece || count >= 32) continue;
+        
+        packed.occupancy |= 1ULL << square;
+        uint8_t code = static_cast<uint8_t>(piece->getType()) | (piece->isWhite() ? 0 : 8);
+        packed.pieces[count / 2] |= (count % 2 == 0) ? code : static_cast<uint8_t>(code << 4);
+        count++;
+    }
+    
+    const GameState& state = board.getGameState();
+    packed.flags = (state.currentPlayer == Color::BLACK ? 1 : 0) |
+                   (state.whiteCanCastleKingside ? 2 : 0) | (state.whiteCanCastleQueenside ? 4 : 0) |
+                   (state.blackCanCastleKingside ? 8 : 0) | (state.blackCanCastleQueenside ? 16 : 0);
+    packed.enPassantSquare = (state.enPassantTarget.row >= 0)
+        ? static_cast<uint8_t>(state.enPassantTarget.row * 8 + state.enPassantTarget.col)
+        : PackedPosition::NO_SQUARE;
+    packed.halfmoveClock = static_cast<uint8_t>(std::min(state.halfmoveClock, 255));
+    packed.fullmoveNumber = static_cast<uint16_t>(std::min(state.fullmoveNumber, 65535));
+    packed.result = static_cast<uint8_t>(result);
+    packed.score = static_cast<int16_t>(std::max(-32000, std::min(32000, score)));
+    return packed;
+}
+
+bool unpackPosition(const PackedPosition& packed, Board& board) {
+    board.clear();
+    
+    int count = 0;
+    for (int square = 0; square < 64; square++) {
+        if (!(packed.occupancy & (1ULL << square))) continue;
+        if (count >= 32) return false;
+        
+        uint8_t code = (packed.pieces[count / 2] >> ((count % 2) * 4)) & 0x0F;
+        count++;
+        if ((code & 7) > static_cast<uint8_t>(PieceType::KING)) return false;
+        
+        Color color = (code & 8) ? Color::BLACK : Color::WHITE;
+        board.setPiece(Position(square / 8, square % 8), static_cast<PieceType>(code & 7), color);
+    }
+    
+    GameState state;
+    state.currentPlayer = (packed.flags & 1) ? Color::BLACK : Color::WHITE;
+    state.whiteCanCastleKingside = packed.flags & 2;
+    state.whiteCanCastleQueenside = packed.flags & 4;
+    state.blackCanCastleKingside = packed.flags & 8;
+    state.blackCanCastleQueenside = packed.flags & 16;
+    if (packed.enPassantSquare < 64) {
+        state.enPassantTarget = Position(packed.enPassantSquare / 8, packed.enPassantSquare % 8);
+    }
+    state.halfmoveClock = packed.halfmoveClock;
+    state.fullmoveNumber = packed.fullmoveNumber;
+    board.setGameState(state);
+    return true;
+}
+
+void writePositionFileHeader(std::ostream& out) {
+    out.write(POSITION_MAGIC, sizeof(POSITION_MAGIC));
+}
+
+PositionWriter::PositionWriter(const std::string& path)
+    : out(path, std::ios::binary | std::ios::trunc), written(0) {
+    if (out) {
+        writePositionFileHeader(out);
+        buffer.reserve(BUFFER_RECORDS);
+    }
+}
+
+PositionWriter::~PositionWriter() {
+    flush();
+}
+
+void PositionWriter::write(const PackedPosition& position) {
+    buffer.push_back(position);
+    if (buffer.size() >= BUFFER_RECORDS) flush();
+}
+
+void PositionWriter::flush() {
+    if (!out || buffer.empty()) return;
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(PackedPosition));
+    out.flush();
+    written += buffer.size();
+    buffer.clear();
+}
+
+bool PositionReader::open(const std::string& path) {
+    if (!file.open(path)) return false;
+    if (file.size() < sizeof(POSITION_MAGIC) ||
+        std::memcmp(file.data(), POSITION_MAGIC, sizeof(POSITION_MAGIC)) != 0) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+size_t PositionReader::size() const {
+    return file.isOpen() ? (file.size() - sizeof(POSITION_MAGIC)) / sizeof(PackedPosition) : 0;
+}
+
+PackedPosition PositionReader::operator[](size_t index) const {
+    PackedPosition packed;
+    std::memcpy(&packed, file.data() + sizeof(POSITION_MAGIC) + index * sizeof(PackedPosition), sizeof(packed));
+    return packed;
+}
+
+GameWriter::GameWriter(const std::string& path)
+    : out(path, std::ios::binary | std::ios::trunc), games(0) {
+    if (out) {
+        out.write(GAME_MAGIC, sizeof(GAME_MAGIC));
+        buffer.reserve(BUFFER_BYTES + 4096);
+    }
+}
+
+GameWriter::~GameWriter() {
+    flush();
+}
+
+void GameWriter::write(const Board& startPosition, const std::vector<Move>& moves, GameResult result) {
+    PackedPosition start = packPosition(startPosition, 0, result);
+    uint16_t count = static_cast<uint16_t>(std::min<size_t>(moves.size(), 65535));
+    
+    const char* startBytes = reinterpret_cast<const char*>(&start);
+    buffer.insert(buffer.end(), startBytes, startBytes + sizeof(start));
+    buffer.insert(buffer.end(), reinterpret_cast<const char*>(&count), reinterpret_cast<const char*>(&count) + 2);
+    for (size_t i = 0; i < count; i++) {
+        uint16_t code = packMove(moves[i]);
+        buffer.insert(buffer.end(), reinterpret_cast<const char*>(&code), reinterpret_cast<const char*>(&code) + 2);
+    }
+    games++;
+    
+    if (buffer.size() >= BUFFER_BYTES) flush();
+}
+
+void GameWriter::flush() {
+    if (!out || buffer.empty()) return;
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    buffer.clear();
+}
+
+uint16_t GameView::moveAt(size_t index) const {
+    uint16_t code;
+    std::memcpy(&code, moveData + index * 2, 2);
+    return code;
+}
+
+bool GameReader::open(const std::string& path) {
+    if (!file.open(path, true)) return false;
+    if (file.size() < sizeof(GAME_MAGIC) || std::memcmp(file.data(), GAME_MAGIC, sizeof(GAME_MAGIC)) != 0) {
+        file.close();
+        return false;
+    }
+    offset = sizeof(GAME_MAGIC);
+    return true;
+}
+
+bool GameReader::next(GameView& game) {
+    if (!file.isOpen() || offset + sizeof(PackedPosition) + 2 > file.size()) return false;
+    
+    std::memcpy(&game.start, file.data() + offset, sizeof(PackedPosition));
+    std::memcpy(&game.moveCount, file.data() + offset + sizeof(PackedPosition), 2);
+    size_t recordSize = sizeof(PackedPosition) + 2 + game.moveCount * 2;
+    if (offset + recordSize > file.size()) return false;
+    
+    game.moveData = file.data() + offset + sizeof(PackedPosition) + 2;
+    offset += recordSize;
+    return true;
+}
+
+void GameReader::rewind() {
+    offset = sizeof(GAME_MAGIC);
+}
\ No newline at end of file
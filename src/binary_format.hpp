@@ -0,0 +1,107 @@
+#pragma once
+#include "board.hpp"
+#include "game.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// 32-byte position record. Squares are numbered row * 8 + col (a8 = 0, h1 = 63);
+// `pieces` holds one 4-bit code per occupied square in ascending square
+// order, low nibble first, with code = PieceType + 8 for Black.
+struct PackedPosition {
+    uint64_t occupancy;
+    uint8_t pieces[16];
+    uint8_t flags;              // bit 0: Black to move, bits 1-4: castling KQkq
+    uint8_t enPassantSquare;    // NO_SQUARE when unavailable
+    uint8_t halfmoveClock;
+    uint8_t result;             // GameResult, ONGOING when unknown
+    uint16_t fullmoveNumber;
+    int16_t score;              // centipawns from the side to move's point of view
+    
+    static constexpr uint8_t NO_SQUARE = 0xFF;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+static_assert(std::is_trivially_copyable<PackedPosition>::value, "PackedPosition is written with memcpy");
+
+PackedPosition packPosition(const Board& board, int score = 0, GameResult result = GameResult::ONGOING);
+bool unpackPosition(const PackedPosition& packed, Board& board);
+
+// Position files: an 8-byte magic followed by PackedPosition records in host
+// (little-endian) byte order.
+void writePositionFileHeader(std::ostream& out);
+
+class PositionWriter {
+private:
+    std::ofstream out;
+    std::vector<PackedPosition> buffer;
+    unsigned long long written;
+    
+public:
+    static constexpr size_t BUFFER_RECORDS = 1 << 15;
+    
+    explicit PositionWriter(const std::string& path);
+    ~PositionWriter();
+    
+    bool isOpen() const { return out.is_open(); }
+    void write(const PackedPosition& position);
+    void flush();
+    unsigned long long getCount() const { return written + buffer.size(); }
+};
+
+class PositionReader {
+private:
+    MappedFile file;
+    
+public:
+    bool open(const std::string& path);
+    
+    size_t size() const;
+    PackedPosition operator[](size_t index) const;
+};
+
+// Game files: an 8-byte magic followed by one record per game: the packed
+// start position (its `result` is the game result), a uint16 move count and
+// that many 16-bit moves from packMove().
+class GameWriter {
+private:
+    std::ofstream out;
+    std::vector<char> buffer;
+    unsigned long long games;
+    
+public:
+    static constexpr size_t BUFFER_BYTES = 1 << 20;
+    
+    explicit GameWriter(const std::string& path);
+    ~GameWriter();
+    
+    bool isOpen() const { return out.is_open(); }
+    void write(const Board& startPosition, const std::vector<Move>& moves, GameResult result);
+    void flush();
+    unsigned long long getCount() const { return games; }
+};
+
+struct GameView {
+    PackedPosition start;
+    const char* moveData;
+    uint16_t moveCount;
+    
+    uint16_t moveAt(size_t index) const;
+    GameResult result() const { return static_cast<GameResult>(start.result); }
+};
+
+class GameReader {
+private:
+    MappedFile file;
+    size_t offset;
+    
+public:
+    GameReader() : offset(0) {}
+    
+    bool open(const std::string& path);
+    bool next(GameView& game);
+    void rewind();
+};
\ No newline at end of file
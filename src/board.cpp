@@ -5,85 +5,97 @@
 #include "pieces/bishop.hpp"
 #include "pieces/queen.hpp"
 #include "pieces/king.hpp"
+#include "pieces/movegen.hpp"
+#include "zobrist.hpp"
+#include "instrument.hpp"
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <cctype>
 
-Board::Board() {
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            squares[i][j] = nullptr;
-        }
+static const Pawn WHITE_PAWN(Color::WHITE), BLACK_PAWN(Color::BLACK);
+static const Rook WHITE_ROOK(Color::WHITE), BLACK_ROOK(Color::BLACK);
+static const Knight WHITE_KNIGHT(Color::WHITE), BLACK_KNIGHT(Color::BLACK);
+static const Bishop WHITE_BISHOP(Color::WHITE), BLACK_BISHOP(Color::BLACK);
+static const Queen WHITE_QUEEN(Color::WHITE), BLACK_QUEEN(Color::BLACK);
+static const King WHITE_KING(Color::WHITE), BLACK_KING(Color::BLACK);
+
+const Piece* const PIECES_BY_CODE[13] = {
+    nullptr,
+    &WHITE_PAWN, &WHITE_ROOK, &WHITE_KNIGHT, &WHITE_BISHOP, &WHITE_QUEEN, &WHITE_KING,
+    &BLACK_PAWN, &BLACK_ROOK, &BLACK_KNIGHT, &BLACK_BISHOP, &BLACK_QUEEN, &BLACK_KING
+};
+
+static uint8_t symbolCode(char symbol) {
+    Color color = std::isupper(static_cast<unsigned char>(symbol)) ? Color::WHITE : Color::BLACK;
+    switch (std::tolower(static_cast<unsigned char>(symbol))) {
+        case 'p': return pieceCode(PieceType::PAWN, color);
+        case 'r': return pieceCode(PieceType::ROOK, color);
+        case 'n': return pieceCode(PieceType::KNIGHT, color);
+        case 'b': return pieceCode(PieceType::BISHOP, color);
+        case 'q': return pieceCode(PieceType::QUEEN, color);
+        case 'k': return pieceCode(PieceType::KING, color);
+        default: return NO_PIECE;
     }
+}
+
+static uint8_t castlingBits(const GameState& state) {
+    return static_cast<uint8_t>(state.whiteCanCastleKingside | (state.whiteCanCastleQueenside << 1) |
+                                (state.blackCanCastleKingside << 2) | (state.blackCanCastleQueenside << 3));
+}
+
+Board::Board() {
+    clear();
     setupInitialPosition();
 }
 
-Board::Board(const Board& other) : state(other.state), stateHistory(other.stateHistory) {
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (other.squares[i][j]) {
-                squares[i][j] = other.squares[i][j]->clone();
-            } else {
-                squares[i][j] = nullptr;
-            }
-        }
-    }
-    
-    for (const auto& move : other.moveHistory) {
-        Move copiedMove(move.from, move.to, move.type);
-        copiedMove.promotionPiece = move.promotionPiece;
-        if (move.capturedPiece) {
-            copiedMove.capturedPiece = move.capturedPiece->clone();
-        }
-        moveHistory.push_back(std::move(copiedMove));
-    }
+void Board::setPiece(const Position& pos, PieceType type, Color color) {
+    if (!isValidPosition(pos)) return;
+    removePiece(pos);
+    position.squares[pos.row * 8 + pos.col] = pieceCode(type, color);
+    position.pieceKey ^= Zobrist::pieceKey(type, color, pos);
 }
 
-Board& Board::operator=(const Board& other) {
-    if (this != &other) {
-        state = other.state;
-        stateHistory = other.stateHistory;
-        
-        for (int i = 0; i < 8; i++) {
-            for (int j = 0; j < 8; j++) {
-                if (other.squares[i][j]) {
-                    squares[i][j] = other.squares[i][j]->clone();
-                } else {
-                    squares[i][j] = nullptr;
-                }
-            }
-        }
-        
-        moveHistory.clear();
-        for (const auto& move : other.moveHistory) {
-            Move copiedMove(move.from, move.to, move.type);
-            copiedMove.promotionPiece = move.promotionPiece;
-            if (move.capturedPiece) {
-                copiedMove.capturedPiece = move.capturedPiece->clone();
-            }
-            moveHistory.push_back(std::move(copiedMove));
-        }
-    }
-    return *this;
+void Board::removePiece(const Position& pos) {
+    if (!isValidPosition(pos)) return;
+    uint8_t& square = position.squares[pos.row * 8 + pos.col];
+    if (square != NO_PIECE) position.pieceKey ^= Zobrist::pieceKey(codeType(square), codeColor(square), pos);
+    square = NO_PIECE;
 }
 
-bool Board::isValidPosition(const Position& pos) const {
-    return pos.row >= 0 && pos.row < 8 && pos.col >= 0 && pos.col < 8;
+// Moves whatever stands on `from` to the empty square `to`; nothing if
+// `from` is empty
+void Board::movePiece(const Position& from, const Position& to) {
+    uint8_t& source = position.squares[from.row * 8 + from.col];
+    if (source == NO_PIECE) return;
+    PieceType type = codeType(source);
+    Color color = codeColor(source);
+    position.pieceKey ^= Zobrist::pieceKey(type, color, from) ^ Zobrist::pieceKey(type, color, to);
+    position.squares[to.row * 8 + to.col] = source;
+    source = NO_PIECE;
 }
 
-Piece* Board::getPiece(const Position& pos) const {
-    if (!isValidPosition(pos)) return nullptr;
-    return squares[pos.row][pos.col].get();
+uint64_t Board::getKey() const {
+    return position.pieceKey ^ Zobrist::stateKey(*this);
 }
 
-void Board::setPiece(const Position& pos, std::unique_ptr<Piece> piece) {
-    if (isValidPosition(pos)) {
-        squares[pos.row][pos.col] = std::move(piece);
+int Board::repetitionCount() const {
+    uint64_t key = getKey();
+    int window = std::min(position.state.halfmoveClock, history.size());
+    int count = 0;
+    // A position needs at least four plies to recur
+    for (int plies = 4; plies <= window; plies += 2) {
+        if (history.recent(plies).key == key) count++;
     }
+    return count;
 }
 
-std::unique_ptr<Piece> Board::removePiece(const Position& pos) {
-    if (!isValidPosition(pos)) return nullptr;
-    return std::move(squares[pos.row][pos.col]);
+void Board::copyKeyHistory(const Board& other) {
+    int window = std::min(std::max(0, other.position.state.halfmoveClock), other.history.size());
+    history.clear();
+    for (int plies = window; plies >= 1; plies--) history.push(other.history.recent(plies));
 }
 
 bool Board::isPathClear(const Position& from, const Position& to) const {
@@ -107,56 +119,113 @@ bool Board::isPathClear(const Position& from, const Position& to) const {
 }
 
 Position Board::findKing(Color color) const {
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            Piece* piece = getPiece(Position(i, j));
-            if (piece && piece->getType() == PieceType::KING && piece->getColor() == color) {
-                return Position(i, j);
-            }
-        }
+    uint8_t king = pieceCode(PieceType::KING, color);
+    for (int square = 0; square < 64; square++) {
+        if (position.squares[square] == king) return Position(square / 8, square % 8);
     }
     return Position(-1, -1);
 }
 
-std::vector<Move> Board::getPseudoLegalAttacks(Color color) const {
-    std::vector<Move> moves;
+// Looks outward from `pos` for pieces of `attackingColor` that attack it.
+// `at(row, col)` supplies the occupant's piece code, so the same test runs on the live
+// board and on a hypothetical position with one move applied.
+template <typename Lookup>
+static bool squareAttackedBy(const Lookup& at, const Position& pos, Color attackingColor) {
+    auto holds = [&](int row, int col, PieceType type, PieceType altType) {
+        if (row < 0 || row >= 8 || col < 0 || col >= 8) return false;
+        uint8_t code = at(row, col);
+        return code == pieceCode(type, attackingColor) || code == pieceCode(altType, attackingColor);
+    };
+    
+    int pawnRow = pos.row + (attackingColor == Color::WHITE ? 1 : -1);
+    if (holds(pawnRow, pos.col - 1, PieceType::PAWN, PieceType::PAWN) ||
+        holds(pawnRow, pos.col + 1, PieceType::PAWN, PieceType::PAWN)) {
+        return true;
+    }
+    
+    int knightMoves[8][2] = {
+        {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+        {1, -2}, {1, 2}, {2, -1}, {2, 1}
+    };
+    int directions[8][2] = {
+        {-1, 0}, {1, 0}, {0, -1}, {0, 1},
+        {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
+    };
     
     for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            Piece* piece = getPiece(Position(i, j));
-            if (piece && piece->getColor() == color) {
-                if (piece->getType() == PieceType::KING) {
-                    int directions[8][2] = {
-                        {-1, -1}, {-1, 0}, {-1, 1},
-                        {0, -1},           {0, 1},
-                        {1, -1},  {1, 0},  {1, 1}
-                    };
-                    
-                    for (int d = 0; d < 8; d++) {
-                        Position newPos(i + directions[d][0], j + directions[d][1]);
-                        if (newPos.row >= 0 && newPos.row < 8 && newPos.col >= 0 && newPos.col < 8) {
-                            moves.emplace_back(Position(i, j), newPos);
-                        }
-                    }
-                } else {
-                    auto pieceMoves = piece->getLegalMoves(*this, Position(i, j));
-                    moves.insert(moves.end(), pieceMoves.begin(), pieceMoves.end());
+        if (holds(pos.row + knightMoves[i][0], pos.col + knightMoves[i][1], PieceType::KNIGHT, PieceType::KNIGHT) ||
+            holds(pos.row + directions[i][0], pos.col + directions[i][1], PieceType::KING, PieceType::KING)) {
+            return true;
+        }
+    }
+    
+    for (int d = 0; d < 8; d++) {
+        PieceType slider = (d < 4) ? PieceType::ROOK : PieceType::BISHOP;
+        int row = pos.row + directions[d][0];
+        int col = pos.col + directions[d][1];
+        
+        while (row >= 0 && row < 8 && col >= 0 && col < 8) {
+            uint8_t code = at(row, col);
+            if (code != NO_PIECE) {
+                if (code == pieceCode(slider, attackingColor) || code == pieceCode(PieceType::QUEEN, attackingColor)) {
+                    return true;
                 }
+                break;
             }
+            row += directions[d][0];
+            col += directions[d][1];
         }
     }
     
-    return moves;
+    return false;
 }
 
 bool Board::isSquareAttacked(const Position& pos, Color attackingColor) const {
-    auto attacks = getPseudoLegalAttacks(attackingColor);
-    for (const auto& move : attacks) {
-        if (move.to == pos) {
-            return true;
-        }
+    return squareAttackedBy([this](int row, int col) { return position.squares[row * 8 + col]; }, pos, attackingColor);
+}
+
+bool Board::isKingAttackedAfter(const Move& move, Color kingColor) const {
+    const Piece* mover = getPiece(move.from);
+    if (!mover) return false;
+    
+    // Apply the move to a copy of the squares instead of the board
+    std::array<uint8_t, 64> grid = position.squares;
+    auto at = [&grid](int row, int col) -> uint8_t& { return grid[row * 8 + col]; };
+    
+    Color color = mover->getColor();
+    at(move.to.row, move.to.col) = at(move.from.row, move.from.col);
+    at(move.from.row, move.from.col) = NO_PIECE;
+    
+    if (move.type == MoveType::EN_PASSANT) {
+        at(move.from.row, move.to.col) = NO_PIECE;
+    } else if (move.type == MoveType::CASTLE_KINGSIDE) {
+        at(move.from.row, 5) = at(move.from.row, 7);
+        at(move.from.row, 7) = NO_PIECE;
+    } else if (move.type == MoveType::CASTLE_QUEENSIDE) {
+        at(move.from.row, 3) = at(move.from.row, 0);
+        at(move.from.row, 0) = NO_PIECE;
+    } else if (move.type == MoveType::PROMOTION) {
+        PieceType promoted = move.promotionPiece;
+        if (promoted == PieceType::PAWN || promoted == PieceType::KING) promoted = PieceType::QUEEN;
+        at(move.to.row, move.to.col) = pieceCode(promoted, color);
     }
-    return false;
+    
+    Position kingPos = (kingColor == color && mover->getType() == PieceType::KING) ? move.to : findKing(kingColor);
+    if (kingPos.row == -1) return false;
+    
+    Color attacker = (kingColor == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    return squareAttackedBy(at, kingPos, attacker);
+}
+
+bool Board::leavesKingInCheck(const Move& move) const {
+    INSTRUMENT_SCOPE(LEGALITY);
+    const Piece* mover = getPiece(move.from);
+    return mover && isKingAttackedAfter(move, mover->getColor());
+}
+
+bool Board::givesCheck(const Move& move) const {
+    const Piece* mover = getPiece(move.from);
+    return mover && isKingAttackedAfter(move, mover->isWhite() ? Color::BLACK : Color::WHITE);
 }
 
 bool Board::isInCheck(Color color) const {
@@ -167,186 +236,399 @@ bool Board::isInCheck(Color color) const {
     return isSquareAttacked(kingPos, oppositeColor);
 }
 
-std::vector<Move> Board::getPseudoLegalMoves(Color color) const {
-    std::vector<Move> moves;
+// Whether the generator of a Side piece of `type` on `from` would emit the
+// packed move `code`, worked out from the move's geometry alone
+template <Color Side>
+static bool pseudoLegalFor(const Board& board, PieceType type, Position from, Position to, uint16_t code) {
+    using Traits = SideTraits<Side>;
+    uint16_t kind = code >> 12;
+    uint8_t target = board.getPieceCode(to.row, to.col);
+    if (target != NO_PIECE && codeColor(target) == Side) return false;
+    int deltaRow = to.row - from.row, deltaCol = to.col - from.col;
     
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            Piece* piece = getPiece(Position(i, j));
-            if (piece && piece->getColor() == color) {
-                auto pieceMoves = piece->getLegalMoves(*this, Position(i, j));
-                moves.insert(moves.end(), pieceMoves.begin(), pieceMoves.end());
-            }
+    if (kind == CODE_CASTLE_KINGSIDE || kind == CODE_CASTLE_QUEENSIDE) {
+        constexpr int row = Traits::homeRow;
+        if (type != PieceType::KING || !(from == Position(row, 4))) return false;
+        const GameState& state = board.getGameState();
+        bool kingside = kind == CODE_CASTLE_KINGSIDE;
+        bool allowed = kingside ? (Side == Color::WHITE ? state.whiteCanCastleKingside : state.blackCanCastleKingside)
+                                : (Side == Color::WHITE ? state.whiteCanCastleQueenside : state.blackCanCastleQueenside);
+        if (!allowed || !(to == Position(row, kingside ? 6 : 2))) return false;
+        if (board.getPieceCode(row, kingside ? 7 : 0) != pieceCode(PieceType::ROOK, Side)) return false;
+        for (int col = kingside ? 5 : 1; col <= (kingside ? 6 : 3); col++) {
+            if (board.getPieceCode(row, col) != NO_PIECE) return false;
         }
+        int passed = kingside ? 5 : 3;
+        return !board.isInCheck(Side) && !board.isSquareAttacked(Position(row, passed), Traits::opponent) &&
+               !board.isSquareAttacked(to, Traits::opponent);
     }
     
-    return moves;
-}
-
-std::vector<Move> Board::getLegalMoves(Color color) const {
-    std::vector<Move> pseudoMoves = getPseudoLegalMoves(color);
-    std::vector<Move> legalMoves;
-    
-    for (const auto& move : pseudoMoves) {
-        Board tempBoard = *this;
-        if (tempBoard.makeMove(move) && !tempBoard.isInCheck(color)) {
-            legalMoves.push_back(move);
+    if (type == PieceType::PAWN) {
+        bool promotes = to.row == Traits::promotionRow;
+        if (kind == CODE_EN_PASSANT) {
+            return deltaRow == Traits::forward && (deltaCol == 1 || deltaCol == -1) &&
+                   to == board.getGameState().enPassantTarget;
         }
+        if ((kind >= CODE_PROMOTE_KNIGHT) != promotes) return false;
+        if (deltaCol == 0) {
+            if (target != NO_PIECE) return false;
+            if (deltaRow == Traits::forward) return true;
+            return deltaRow == 2 * Traits::forward && from.row == Traits::pawnStartRow &&
+                   board.getPieceCode(from.row + Traits::forward, from.col) == NO_PIECE;
+        }
+        return deltaRow == Traits::forward && (deltaCol == 1 || deltaCol == -1) && target != NO_PIECE;
+    }
+    if (kind != CODE_NORMAL) return false;
+    
+    int rowDistance = std::abs(deltaRow), colDistance = std::abs(deltaCol);
+    bool straight = deltaRow == 0 || deltaCol == 0;
+    bool diagonal = rowDistance == colDistance;
+    switch (type) {
+        case PieceType::KNIGHT: return rowDistance * colDistance == 2;
+        case PieceType::KING: return std::max(rowDistance, colDistance) == 1;
+        case PieceType::BISHOP: if (!diagonal) return false; break;
+        case PieceType::ROOK: if (!straight) return false; break;
+        case PieceType::QUEEN: if (!straight && !diagonal) return false; break;
+        default: return false;
     }
     
-    return legalMoves;
+    int stepRow = (deltaRow > 0) - (deltaRow < 0), stepCol = (deltaCol > 0) - (deltaCol < 0);
+    for (int row = from.row + stepRow, col = from.col + stepCol; row != to.row || col != to.col;
+         row += stepRow, col += stepCol) {
+        if (board.getPieceCode(row, col) != NO_PIECE) return false;
+    }
+    return true;
 }
 
-void Board::updateCastlingRights(const Move& move) {
-    Piece* piece = getPiece(move.from);
-    if (!piece) return;
+bool Board::isPseudoLegal(uint16_t move) const {
+    INSTRUMENT_SCOPE(LEGALITY);
+    int fromSquare = move & 63, toSquare = (move >> 6) & 63;
+    uint8_t code = position.squares[fromSquare];
+    if (fromSquare == toSquare || code == NO_PIECE || codeColor(code) != getCurrentPlayer()) return false;
+    // Kinds 8-15 are never packed; unpackMove would read them as promotions
+    if ((move >> 12) > CODE_PROMOTE_QUEEN) return false;
     
-    if (piece->getType() == PieceType::KING) {
-        if (piece->isWhite()) {
-            state.whiteCanCastleKingside = false;
-            state.whiteCanCastleQueenside = false;
-        } else {
-            state.blackCanCastleKingside = false;
-            state.blackCanCastleQueenside = false;
+    Position from(fromSquare / 8, fromSquare % 8), to(toSquare / 8, toSquare % 8);
+    if (getCurrentPlayer() == Color::WHITE) return pseudoLegalFor<Color::WHITE>(*this, codeType(code), from, to, move);
+    return pseudoLegalFor<Color::BLACK>(*this, codeType(code), from, to, move);
+}
+
+bool Board::isLegal(uint16_t move) const {
+    return isPseudoLegal(move) && !leavesKingInCheck(unpackMove(move));
+}
+
+template <Color Side, GenType Gen>
+static void generateSideMoves(const Board& board, MoveList& moves) {
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            uint8_t code = board.getPieceCode(i, j);
+            if (code != NO_PIECE && codeColor(code) == Side) {
+                generatePieceMoves<Side, Gen>(board, codeType(code), Position(i, j), moves);
+            }
         }
     }
+}
+
+template <GenType Gen>
+static void generateMoves(const Board& board, Color color, MoveList& moves) {
+    INSTRUMENT_SCOPE(MOVE_GENERATION);
+    if (color == Color::WHITE) generateSideMoves<Color::WHITE, Gen>(board, moves);
+    else generateSideMoves<Color::BLACK, Gen>(board, moves);
+}
+
+void Board::generatePseudoLegalMoves(Color color, MoveList& moves) const {
+    generateMoves<GenType::ALL>(*this, color, moves);
+}
+
+void Board::generateCaptures(Color color, MoveList& moves) const {
+    generateMoves<GenType::CAPTURES>(*this, color, moves);
+}
+
+void Board::generateQuiets(Color color, MoveList& moves) const {
+    generateMoves<GenType::QUIETS>(*this, color, moves);
+}
+
+void Board::generateQuietChecks(Color color, MoveList& moves) const {
+    INSTRUMENT_SCOPE(MOVE_GENERATION);
+    size_t first = moves.size();
+    generateQuiets(color, moves);
+    moves.erase(std::remove_if(moves.begin() + first, moves.end(),
+                               [this](const Move& move) { return !givesCheck(move); }),
+                moves.end());
+}
+
+// Squares on which a piece other than the king answers a check on `king`:
+// the checking piece and, for a slider, the squares in between. None in a
+// double check, which only a king move answers.
+static uint64_t evasionTargets(const Board& board, Position king, Color attacker) {
+    uint64_t targets = 0;
+    int checkers = 0;
+    auto holds = [&](int row, int col, PieceType type) {
+        return row >= 0 && row < 8 && col >= 0 && col < 8 && board.getPieceCode(row, col) == pieceCode(type, attacker);
+    };
+    auto check = [&](uint64_t squares) {
+        targets |= squares;
+        checkers++;
+    };
     
-    if (piece->getType() == PieceType::ROOK) {
-        if (piece->isWhite()) {
-            if (move.from == Position(7, 0)) state.whiteCanCastleQueenside = false;
-            if (move.from == Position(7, 7)) state.whiteCanCastleKingside = false;
-        } else {
-            if (move.from == Position(0, 0)) state.blackCanCastleQueenside = false;
-            if (move.from == Position(0, 7)) state.blackCanCastleKingside = false;
+    int pawnRow = king.row + (attacker == Color::WHITE ? 1 : -1);
+    for (int colOffset : {-1, 1}) {
+        if (holds(pawnRow, king.col + colOffset, PieceType::PAWN)) check(1ULL << (pawnRow * 8 + king.col + colOffset));
+    }
+    for (const auto& step : KNIGHT_STEPS) {
+        int row = king.row + step[0], col = king.col + step[1];
+        if (holds(row, col, PieceType::KNIGHT)) check(1ULL << (row * 8 + col));
+    }
+    for (const auto& step : KING_STEPS) {
+        PieceType slider = (step[0] == 0 || step[1] == 0) ? PieceType::ROOK : PieceType::BISHOP;
+        uint64_t ray = 0;
+        int row = king.row + step[0], col = king.col + step[1];
+        while (row >= 0 && row < 8 && col >= 0 && col < 8) {
+            ray |= 1ULL << (row * 8 + col);
+            uint8_t code = board.getPieceCode(row, col);
+            if (code != NO_PIECE) {
+                if (code == pieceCode(slider, attacker) || code == pieceCode(PieceType::QUEEN, attacker)) check(ray);
+                break;
+            }
+            row += step[0];
+            col += step[1];
         }
     }
+    return checkers == 1 ? targets : 0;
 }
 
-void Board::updateEnPassant(const Move& move) {
-    state.enPassantTarget = Position(-1, -1);
+void Board::generateEvasions(Color color, MoveList& moves) const {
+    INSTRUMENT_SCOPE(MOVE_GENERATION);
+    Position king = findKing(color);
+    if (king.row == -1) {
+        generatePseudoLegalMoves(color, moves);
+        return;
+    }
+    
+    uint64_t targets = evasionTargets(*this, king, color == Color::WHITE ? Color::BLACK : Color::WHITE);
+    size_t first = moves.size();
+    generatePseudoLegalMoves(color, moves);
     
-    Piece* piece = getPiece(move.to);
-    if (piece && piece->getType() == PieceType::PAWN) {
-        if (abs(move.to.row - move.from.row) == 2) {
-            state.enPassantTarget = Position((move.from.row + move.to.row) / 2, move.from.col);
+    // King moves stay; any other move has to capture the checker or block.
+    // En passant captures a pawn beside the square it lands on.
+    moves.erase(std::remove_if(moves.begin() + first, moves.end(), [&](const Move& move) {
+                    if (move.from == king) return false;
+                    uint64_t squares = 1ULL << (move.to.row * 8 + move.to.col);
+                    if (move.type == MoveType::EN_PASSANT) squares |= 1ULL << (move.from.row * 8 + move.to.col);
+                    return !(targets & squares);
+                }),
+                moves.end());
+}
+
+std::vector<Move> Board::getPseudoLegalMoves(Color color) const {
+    MoveList moves;
+    generatePseudoLegalMoves(color, moves);
+    return std::vector<Move>(std::make_move_iterator(moves.begin()), std::make_move_iterator(moves.end()));
+}
+
+// Bare kings, or a single minor piece: neither side can ever mate
+bool Board::isInsufficientMaterial() const {
+    int minors = 0;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            const Piece* piece = getPiece(Position(i, j));
+            if (!piece) continue;
+            
+            PieceType type = piece->getType();
+            if (type == PieceType::KNIGHT || type == PieceType::BISHOP) {
+                if (++minors > 1) return false;
+            } else if (type != PieceType::KING) {
+                return false;
+            }
         }
     }
+    return true;
 }
 
-bool Board::makeMove(const Move& move) {
-    if (!isValidPosition(move.from) || !isValidPosition(move.to)) {
-        return false;
+void Board::generateLegalMoves(Color color, MoveList& moves) const {
+    size_t first = moves.size();
+    generatePseudoLegalMoves(color, moves);
+    moves.erase(std::remove_if(moves.begin() + first, moves.end(),
+                               [this](const Move& move) { return leavesKingInCheck(move); }),
+                moves.end());
+}
+
+std::vector<Move> Board::getLegalMoves(Color color) const {
+    MoveList moves;
+    generateLegalMoves(color, moves);
+    return std::vector<Move>(std::make_move_iterator(moves.begin()), std::make_move_iterator(moves.end()));
+}
+
+bool Board::hasLegalMoves(Color color) const {
+    MoveList moves;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            const Piece* piece = getPiece(Position(i, j));
+            if (piece && piece->getColor() == color) {
+                moves.clear();
+                if (color == Color::WHITE) generatePieceMoves<Color::WHITE>(*this, piece->getType(), Position(i, j), moves);
+                else generatePieceMoves<Color::BLACK>(*this, piece->getType(), Position(i, j), moves);
+                for (const auto& move : moves) {
+                    if (!leavesKingInCheck(move)) return true;
+                }
+            }
+        }
     }
+    return false;
+}
+
+// The side to move is a template parameter from here on, so that castling
+// squares, the pawn direction and the promotion color are constants
+template <Color Side>
+void Board::updateCastlingRights(const Move& move, PieceType mover) {
+    constexpr bool white = Side == Color::WHITE;
+    constexpr int ownRow = SideTraits<Side>::homeRow;
+    constexpr int theirRow = SideTraits<SideTraits<Side>::opponent>::homeRow;
+    GameState& state = position.state;
+    bool& kingside = white ? state.whiteCanCastleKingside : state.blackCanCastleKingside;
+    bool& queenside = white ? state.whiteCanCastleQueenside : state.blackCanCastleQueenside;
+    bool& theirKingside = white ? state.blackCanCastleKingside : state.whiteCanCastleKingside;
+    bool& theirQueenside = white ? state.blackCanCastleQueenside : state.whiteCanCastleQueenside;
     
-    Piece* piece = getPiece(move.from);
-    if (!piece) return false;
+    // Capturing a rook on its home square also removes that castling right
+    if (move.to == Position(theirRow, 0)) theirQueenside = false;
+    if (move.to == Position(theirRow, 7)) theirKingside = false;
     
-    stateHistory.push_back(state);
-    moveHistory.push_back(move);
+    if (mover == PieceType::KING) {
+        kingside = false;
+        queenside = false;
+    } else if (mover == PieceType::ROOK) {
+        if (move.from == Position(ownRow, 0)) queenside = false;
+        if (move.from == Position(ownRow, 7)) kingside = false;
+    }
+}
+
+template <Color Side>
+void Board::makeMoveAs(const Move& move) {
+    using Traits = SideTraits<Side>;
+    constexpr int row = Traits::homeRow;
+    GameState& state = position.state;
     
-    Move& mutableMove = const_cast<Move&>(move);
-    mutableMove.capturedPiece = removePiece(move.to);
+    PieceType mover = codeType(getPieceCode(move.from.row, move.from.col));
+    uint8_t captured = getPieceCode(move.to.row, move.to.col);
+    Position enPassant = state.enPassantTarget;
+    history.push(UndoEntry{getKey(), packMove(move), static_cast<uint16_t>(state.halfmoveClock), captured,
+                           castlingBits(state),
+                           static_cast<int8_t>(enPassant.row < 0 ? -1 : enPassant.row * 8 + enPassant.col)});
     
-    if (move.type == MoveType::CASTLE_KINGSIDE) {
-        if (piece->isWhite()) {
-            setPiece(Position(7, 6), removePiece(Position(7, 4)));
-            setPiece(Position(7, 5), removePiece(Position(7, 7)));
-        } else {
-            setPiece(Position(0, 6), removePiece(Position(0, 4)));
-            setPiece(Position(0, 5), removePiece(Position(0, 7)));
-        }
-    } else if (move.type == MoveType::CASTLE_QUEENSIDE) {
-        if (piece->isWhite()) {
-            setPiece(Position(7, 2), removePiece(Position(7, 4)));
-            setPiece(Position(7, 3), removePiece(Position(7, 0)));
-        } else {
-            setPiece(Position(0, 2), removePiece(Position(0, 4)));
-            setPiece(Position(0, 3), removePiece(Position(0, 0)));
-        }
-    } else if (move.type == MoveType::EN_PASSANT) {
-        int captureRow = piece->isWhite() ? move.to.row + 1 : move.to.row - 1;
-        mutableMove.capturedPiece = removePiece(Position(captureRow, move.to.col));
-        setPiece(move.to, removePiece(move.from));
-    } else if (move.type == MoveType::PROMOTION) {
-        removePiece(move.from);
-        switch (move.promotionPiece) {
-            case PieceType::QUEEN:
-                setPiece(move.to, std::make_unique<Queen>(piece->getColor()));
-                break;
-            case PieceType::ROOK:
-                setPiece(move.to, std::make_unique<Rook>(piece->getColor()));
-                break;
-            case PieceType::BISHOP:
-                setPiece(move.to, std::make_unique<Bishop>(piece->getColor()));
-                break;
-            case PieceType::KNIGHT:
-                setPiece(move.to, std::make_unique<Knight>(piece->getColor()));
-                break;
-            default:
-                setPiece(move.to, std::make_unique<Queen>(piece->getColor()));
-                break;
+    bool resetsClock = mover == PieceType::PAWN || captured != NO_PIECE;
+    updateCastlingRights<Side>(move, mover);
+    
+    switch (move.type) {
+        case MoveType::CASTLE_KINGSIDE:
+            movePiece(Position(row, 4), Position(row, 6));
+            movePiece(Position(row, 7), Position(row, 5));
+            break;
+        case MoveType::CASTLE_QUEENSIDE:
+            movePiece(Position(row, 4), Position(row, 2));
+            movePiece(Position(row, 0), Position(row, 3));
+            break;
+        case MoveType::EN_PASSANT:
+            removePiece(Position(move.to.row - Traits::forward, move.to.col));
+            movePiece(move.from, move.to);
+            break;
+        case MoveType::PROMOTION: {
+            PieceType promoted = move.promotionPiece;
+            if (promoted == PieceType::PAWN || promoted == PieceType::KING) promoted = PieceType::QUEEN;
+            removePiece(move.from);
+            setPiece(move.to, promoted, Side);
+            break;
         }
-    } else {
-        setPiece(move.to, removePiece(move.from));
+        default:
+            removePiece(move.to);
+            movePiece(move.from, move.to);
+            break;
     }
     
-    updateCastlingRights(move);
-    updateEnPassant(move);
+    bool doublePush = mover == PieceType::PAWN && move.to.row - move.from.row == 2 * Traits::forward;
+    state.enPassantTarget = doublePush ? Position(move.from.row + Traits::forward, move.from.col) : Position(-1, -1);
     
+    state.halfmoveClock = resetsClock ? 0 : state.halfmoveClock + 1;
     state.currentPlayer = (state.currentPlayer == Color::WHITE) ? Color::BLACK : Color::WHITE;
     if (state.currentPlayer == Color::WHITE) {
         state.fullmoveNumber++;
     }
+}
+
+template <Color Side>
+void Board::undoMoveAs(const Move& move, uint8_t captured) {
+    using Traits = SideTraits<Side>;
+    constexpr int row = Traits::homeRow;
+    
+    switch (move.type) {
+        case MoveType::CASTLE_KINGSIDE:
+            movePiece(Position(row, 6), Position(row, 4));
+            movePiece(Position(row, 5), Position(row, 7));
+            break;
+        case MoveType::CASTLE_QUEENSIDE:
+            movePiece(Position(row, 2), Position(row, 4));
+            movePiece(Position(row, 3), Position(row, 0));
+            break;
+        case MoveType::EN_PASSANT:
+            movePiece(move.to, move.from);
+            setPiece(Position(move.to.row - Traits::forward, move.to.col), PieceType::PAWN, Traits::opponent);
+            break;
+        case MoveType::PROMOTION:
+            setPiece(move.from, PieceType::PAWN, Side);
+            removePiece(move.to);
+            break;
+        default:
+            movePiece(move.to, move.from);
+            break;
+    }
+    if (captured != NO_PIECE && move.type != MoveType::EN_PASSANT) {
+        setPiece(move.to, codeType(captured), codeColor(captured));
+    }
+}
+
+bool Board::makeMove(const Move& move) {
+    INSTRUMENT_SCOPE(MAKE_MOVE);
+    if (!isValidPosition(move.from) || !isValidPosition(move.to)) {
+        return false;
+    }
+    
+    const Piece* piece = getPiece(move.from);
+    if (!piece) return false;
     
+    if (piece->isWhite()) makeMoveAs<Color::WHITE>(move);
+    else makeMoveAs<Color::BLACK>(move);
     return true;
 }
 
 void Board::undoMove() {
-    if (moveHistory.empty()) return;
+    INSTRUMENT_SCOPE(UNDO_MOVE);
+    if (history.empty()) return;
     
-    Move lastMove = moveHistory.back();
-    moveHistory.pop_back();
+    UndoEntry entry = history.pop();
+    Move lastMove = unpackMove(entry.move);
     
-    state = stateHistory.back();
-    stateHistory.pop_back();
+    GameState& state = position.state;
+    state.currentPlayer = (state.currentPlayer == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    if (state.currentPlayer == Color::BLACK) state.fullmoveNumber--;
+    state.whiteCanCastleKingside = entry.castling & 1;
+    state.whiteCanCastleQueenside = entry.castling & 2;
+    state.blackCanCastleKingside = entry.castling & 4;
+    state.blackCanCastleQueenside = entry.castling & 8;
+    state.enPassantTarget = entry.enPassantSquare < 0 ? Position(-1, -1)
+                                                      : Position(entry.enPassantSquare / 8, entry.enPassantSquare % 8);
+    state.halfmoveClock = entry.halfmoveClock;
     
-    if (lastMove.type == MoveType::CASTLE_KINGSIDE) {
-        Color color = getPiece(lastMove.to)->getColor();
-        if (color == Color::WHITE) {
-            setPiece(Position(7, 4), removePiece(Position(7, 6)));
-            setPiece(Position(7, 7), removePiece(Position(7, 5)));
-        } else {
-            setPiece(Position(0, 4), removePiece(Position(0, 6)));
-            setPiece(Position(0, 7), removePiece(Position(0, 5)));
-        }
-    } else if (lastMove.type == MoveType::CASTLE_QUEENSIDE) {
-        Color color = getPiece(lastMove.to)->getColor();
-        if (color == Color::WHITE) {
-            setPiece(Position(7, 4), removePiece(Position(7, 2)));
-            setPiece(Position(7, 0), removePiece(Position(7, 3)));
-        } else {
-            setPiece(Position(0, 4), removePiece(Position(0, 2)));
-            setPiece(Position(0, 0), removePiece(Position(0, 3)));
-        }
-    } else if (lastMove.type == MoveType::EN_PASSANT) {
-        setPiece(lastMove.from, removePiece(lastMove.to));
-        Color capturedColor = (getPiece(lastMove.from)->getColor() == Color::WHITE) ? Color::BLACK : Color::WHITE;
-        int captureRow = capturedColor == Color::WHITE ? lastMove.to.row + 1 : lastMove.to.row - 1;
-        setPiece(Position(captureRow, lastMove.to.col), std::move(lastMove.capturedPiece));
-    } else {
-        setPiece(lastMove.from, removePiece(lastMove.to));
-        if (lastMove.capturedPiece) {
-            setPiece(lastMove.to, std::move(lastMove.capturedPiece));
-        }
-    }
+    // Whatever moved, king or pawn or promoted piece, now stands on `to`
+    if (getPiece(lastMove.to)->isWhite()) undoMoveAs<Color::WHITE>(lastMove, entry.captured);
+    else undoMoveAs<Color::BLACK>(lastMove, entry.captured);
 }
 
 bool Board::isCheckmate(Color color) const {
-    return isInCheck(color) && getLegalMoves(color).empty();
+    return isInCheck(color) && !hasLegalMoves(color);
 }
 
 bool Board::isStalemate(Color color) const {
-    return !isInCheck(color) && getLegalMoves(color).empty();
+    return !isInCheck(color) && !hasLegalMoves(color);
 }
 
 void Board::display() const {
@@ -354,7 +636,7 @@ void Board::display() const {
     for (int i = 0; i < 8; i++) {
         std::cout << (8 - i) << " ";
         for (int j = 0; j < 8; j++) {
-            Piece* piece = getPiece(Position(i, j));
+            const Piece* piece = getPiece(Position(i, j));
             char symbol = piece ? piece->getSymbol() : '.';
             std::cout << symbol << " ";
         }
@@ -364,26 +646,138 @@ void Board::display() const {
 }
 
 void Board::setupInitialPosition() {
+    const PieceType backRank[8] = {
+        PieceType::ROOK, PieceType::KNIGHT, PieceType::BISHOP, PieceType::QUEEN,
+        PieceType::KING, PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK
+    };
+    for (int i = 0; i < 8; i++) {
+        setPiece(Position(0, i), backRank[i], Color::BLACK);
+        setPiece(Position(1, i), PieceType::PAWN, Color::BLACK);
+        setPiece(Position(6, i), PieceType::PAWN, Color::WHITE);
+        setPiece(Position(7, i), backRank[i], Color::WHITE);
+    }
+} 
+
+void Board::clear() {
+    position.squares.fill(NO_PIECE);
+    position.state = GameState();
+    position.pieceKey = 0;
+    history.clear();
+}
+
+bool Board::loadFEN(const std::string& fen) {
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    if (!(stream >> placement >> side >> castling >> enPassant)) {
+        return false;
+    }
+    
+    std::array<std::array<char, 8>, 8> layout{};
+    int row = 0, col = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (col != 8) return false;
+            row++;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+            if (col > 8) return false;
+        } else {
+            if (row >= 8 || col >= 8 || symbolCode(c) == NO_PIECE) return false;
+            layout[row][col++] = c;
+        }
+    }
+    if (row != 7 || col != 8) return false;
+    
+    // Exactly one king a side, and no pawns on the back ranks
+    int whiteKings = 0, blackKings = 0;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            if (layout[i][j] == 'K') whiteKings++;
+            if (layout[i][j] == 'k') blackKings++;
+            if ((i == 0 || i == 7) && (layout[i][j] == 'P' || layout[i][j] == 'p')) return false;
+        }
+    }
+    if (whiteKings != 1 || blackKings != 1) return false;
+    
+    if (side != "w" && side != "b") return false;
+    
+    GameState newState;
+    newState.currentPlayer = (side == "w") ? Color::WHITE : Color::BLACK;
+    newState.whiteCanCastleKingside = castling.find('K') != std::string::npos;
+    newState.whiteCanCastleQueenside = castling.find('Q') != std::string::npos;
+    newState.blackCanCastleKingside = castling.find('k') != std::string::npos;
+    newState.blackCanCastleQueenside = castling.find('q') != std::string::npos;
+    
+    // Rights whose king or rook has left its home square are dropped
+    if (layout[7][4] != 'K') newState.whiteCanCastleKingside = newState.whiteCanCastleQueenside = false;
+    if (layout[7][7] != 'R') newState.whiteCanCastleKingside = false;
+    if (layout[7][0] != 'R') newState.whiteCanCastleQueenside = false;
+    if (layout[0][4] != 'k') newState.blackCanCastleKingside = newState.blackCanCastleQueenside = false;
+    if (layout[0][7] != 'r') newState.blackCanCastleKingside = false;
+    if (layout[0][0] != 'r') newState.blackCanCastleQueenside = false;
+    
+    if (enPassant != "-") {
+        if (enPassant.length() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' ||
+            enPassant[1] < '1' || enPassant[1] > '8') {
+            return false;
+        }
+        newState.enPassantTarget = Position(8 - (enPassant[1] - '0'), enPassant[0] - 'a');
+    }
+    
+    // Halfmove and fullmove counters are optional (EPD records omit them)
+    int halfmove, fullmove;
+    if (stream >> halfmove >> fullmove) {
+        newState.halfmoveClock = halfmove;
+        newState.fullmoveNumber = std::max(1, fullmove);
+    }
+    
+    clear();
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            uint8_t code = symbolCode(layout[i][j]);
+            if (code != NO_PIECE) setPiece(Position(i, j), codeType(code), codeColor(code));
+        }
+    }
+    position.state = newState;
+    return true;
+}
+
+std::string Board::toFEN() const {
+    std::string fen;
     for (int i = 0; i < 8; i++) {
-        setPiece(Position(1, i), std::make_unique<Pawn>(Color::BLACK));
-        setPiece(Position(6, i), std::make_unique<Pawn>(Color::WHITE));
-    }
-    
-    setPiece(Position(0, 0), std::make_unique<Rook>(Color::BLACK));
-    setPiece(Position(0, 1), std::make_unique<Knight>(Color::BLACK));
-    setPiece(Position(0, 2), std::make_unique<Bishop>(Color::BLACK));
-    setPiece(Position(0, 3), std::make_unique<Queen>(Color::BLACK));
-    setPiece(Position(0, 4), std::make_unique<King>(Color::BLACK));
-    setPiece(Position(0, 5), std::make_unique<Bishop>(Color::BLACK));
-    setPiece(Position(0, 6), std::make_unique<Knight>(Color::BLACK));
-    setPiece(Position(0, 7), std::make_unique<Rook>(Color::BLACK));
-    
-    setPiece(Position(7, 0), std::make_unique<Rook>(Color::WHITE));
-    setPiece(Position(7, 1), std::make_unique<Knight>(Color::WHITE));
-    setPiece(Position(7, 2), std::make_unique<Bishop>(Color::WHITE));
-    setPiece(Position(7, 3), std::make_unique<Queen>(Color::WHITE));
-    setPiece(Position(7, 4), std::make_unique<King>(Color::WHITE));
-    setPiece(Position(7, 5), std::make_unique<Bishop>(Color::WHITE));
-    setPiece(Position(7, 6), std::make_unique<Knight>(Color::WHITE));
-    setPiece(Position(7, 7), std::make_unique<Rook>(Color::WHITE));
-} 
\ No newline at end of file
+        int empty = 0;
+        for (int j = 0; j < 8; j++) {
+            const Piece* piece = getPiece(Position(i, j));
+            if (piece) {
+                if (empty > 0) fen += static_cast<char>('0' + empty);
+                empty = 0;
+                fen += piece->getSymbol();
+            } else {
+                empty++;
+            }
+        }
+        if (empty > 0) fen += static_cast<char>('0' + empty);
+        if (i < 7) fen += '/';
+    }
+    
+    fen += (position.state.currentPlayer == Color::WHITE) ? " w " : " b ";
+    
+    std::string castling;
+    if (position.state.whiteCanCastleKingside) castling += 'K';
+    if (position.state.whiteCanCastleQueenside) castling += 'Q';
+    if (position.state.blackCanCastleKingside) castling += 'k';
+    if (position.state.blackCanCastleQueenside) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+    
+    if (position.state.enPassantTarget.row >= 0) {
+        fen += ' ';
+        fen += static_cast<char>('a' + position.state.enPassantTarget.col);
+        fen += static_cast<char>('8' - position.state.enPassantTarget.row);
+    } else {
+        fen += " -";
+    }
+    
+    fen += " " + std::to_string(position.state.halfmoveClock) + " " + std::to_string(position.state.fullmoveNumber);
+    return fen;
+}
\ No newline at end of file
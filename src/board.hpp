@@ -2,8 +2,10 @@
 #include "pieces/piece.hpp"
 #include "move.hpp"
 #include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
 #include <vector>
-#include <memory>
 
 struct GameState {
     Color currentPlayer;
@@ -21,30 +23,104 @@ struct GameState {
                   enPassantTarget(-1, -1), halfmoveClock(0), fullmoveNumber(1) {}
 };
 
+// Square contents of a position: NO_PIECE, or 1 + color * 6 + type
+constexpr uint8_t NO_PIECE = 0;
+constexpr uint8_t pieceCode(PieceType type, Color color) {
+    return static_cast<uint8_t>(1 + static_cast<int>(color) * 6 + static_cast<int>(type));
+}
+constexpr PieceType codeType(uint8_t code) { return static_cast<PieceType>((code - 1) % 6); }
+constexpr Color codeColor(uint8_t code) { return code > 6 ? Color::BLACK : Color::WHITE; }
+
+// Pieces carry no state beyond their color and type, so every board shares
+// one immutable instance per code (nullptr for NO_PIECE)
+extern const Piece* const PIECES_BY_CODE[13];
+
+// A position and nothing else. Trivially copyable, so that handing a
+// position to a worker is a single memcpy.
+struct PositionSnapshot {
+    std::array<uint8_t, 64> squares;    // piece codes, indexed by row * 8 + col
+    GameState state;
+    uint64_t pieceKey;                  // Zobrist key of the piece placement, kept incrementally
+};
+static_assert(std::is_trivially_copyable<PositionSnapshot>::value, "positions are copied with memcpy");
+static_assert(sizeof(PositionSnapshot) <= 200, "positions should stay within a few cache lines");
+
+// What makeMove records to take a move back: the 16-bit move, the captured
+// piece and the parts of GameState that cannot be recomputed
+struct UndoEntry {
+    uint64_t key;                       // full key before the move, for repetition detection
+    uint16_t move;                      // packMove encoding
+    uint16_t halfmoveClock;
+    uint8_t captured;                   // piece code, NO_PIECE if the move captured nothing
+    uint8_t castling;                   // castling rights, one bit each
+    int8_t enPassantSquare;             // row * 8 + col, -1 for none
+};
+
+// The most recent plies of a game, newest on top. Once CAPACITY plies are
+// recorded the oldest ones are overwritten: by then they are too old to
+// recur under the fifty-move rule. Copies take only the recorded entries.
+class UndoStack {
+public:
+    static constexpr int CAPACITY = 256;
+    
+private:
+    std::array<UndoEntry, CAPACITY> entries;
+    int first;                          // ply number of the oldest recorded entry
+    int count;                          // ply number one past the newest
+    
+public:
+    UndoStack() : first(0), count(0) {}
+    UndoStack(const UndoStack& other) : first(other.first), count(other.count) {
+        for (int ply = first; ply < count; ply++) entries[ply & (CAPACITY - 1)] = other.entries[ply & (CAPACITY - 1)];
+    }
+    UndoStack& operator=(const UndoStack& other) {
+        first = other.first;
+        count = other.count;
+        for (int ply = first; ply < count; ply++) entries[ply & (CAPACITY - 1)] = other.entries[ply & (CAPACITY - 1)];
+        return *this;
+    }
+    
+    int size() const { return count - first; }
+    bool empty() const { return count == first; }
+    void clear() { first = count = 0; }
+    
+    void push(const UndoEntry& entry) {
+        entries[count++ & (CAPACITY - 1)] = entry;
+        if (count - first > CAPACITY) first++;
+    }
+    UndoEntry pop() { return entries[--count & (CAPACITY - 1)]; }
+    
+    // The entry recorded `plies` moves ago, 1 <= plies <= size()
+    const UndoEntry& recent(int plies) const { return entries[(count - plies) & (CAPACITY - 1)]; }
+};
+
 class Board {
 private:
-    std::array<std::array<std::unique_ptr<Piece>, 8>, 8> squares;
-    GameState state;
-    std::vector<Move> moveHistory;
-    std::vector<GameState> stateHistory;
+    PositionSnapshot position;
+    UndoStack history;
     
-    bool isValidPosition(const Position& pos) const;
+    bool isValidPosition(const Position& pos) const {
+        return pos.row >= 0 && pos.row < 8 && pos.col >= 0 && pos.col < 8;
+    }
     bool isPathClear(const Position& from, const Position& to) const;
     Position findKing(Color color) const;
-    void updateCastlingRights(const Move& move);
-    void updateEnPassant(const Move& move);
-    std::vector<Move> getPseudoLegalAttacks(Color color) const;
+    void movePiece(const Position& from, const Position& to);
+    template <Color Side> void updateCastlingRights(const Move& move, PieceType mover);
+    template <Color Side> void makeMoveAs(const Move& move);
+    template <Color Side> void undoMoveAs(const Move& move, uint8_t captured);
+    bool isKingAttackedAfter(const Move& move, Color kingColor) const;
     
 public:
     Board();
-    Board(const Board& other);
-    Board& operator=(const Board& other);
-    Board(Board&&) = default;
-    Board& operator=(Board&&) = default;
+    // A board without history, standing on `snapshot`
+    explicit Board(const PositionSnapshot& snapshot) : position(snapshot) {}
     
-    Piece* getPiece(const Position& pos) const;
-    void setPiece(const Position& pos, std::unique_ptr<Piece> piece);
-    std::unique_ptr<Piece> removePiece(const Position& pos);
+    const Piece* getPiece(const Position& pos) const {
+        return isValidPosition(pos) ? PIECES_BY_CODE[position.squares[pos.row * 8 + pos.col]] : nullptr;
+    }
+    uint8_t getPieceCode(int row, int col) const { return position.squares[row * 8 + col]; }
+    void setPiece(const Position& pos, PieceType type, Color color);
+    void removePiece(const Position& pos);
     
     bool makeMove(const Move& move);
     void undoMove();
@@ -53,13 +129,57 @@ public:
     bool isCheckmate(Color color) const;
     bool isStalemate(Color color) const;
     bool isSquareAttacked(const Position& pos, Color attackingColor) const;
+    bool leavesKingInCheck(const Move& move) const;
+    bool givesCheck(const Move& move) const;
+    bool hasLegalMoves(Color color) const;
+    
+    // Whether a packed move (see packMove) is one the side to move could play
+    // here, checked without generating any moves. Hash moves may come from a
+    // colliding position, so the search tests them with these first.
+    bool isPseudoLegal(uint16_t move) const;
+    bool isLegal(uint16_t move) const;
+    bool isInsufficientMaterial() const;
     
     std::vector<Move> getLegalMoves(Color color) const;
     std::vector<Move> getPseudoLegalMoves(Color color) const;
     
-    Color getCurrentPlayer() const { return state.currentPlayer; }
-    const GameState& getGameState() const { return state; }
+    // Append to `moves` instead; the search uses these with arena-backed lists
+    void generateLegalMoves(Color color, MoveList& moves) const;
+    void generatePseudoLegalMoves(Color color, MoveList& moves) const;
+    
+    // Pseudo-legal moves by class, for generating them in stages. Captures
+    // include en passant and every promotion; quiets are the other moves.
+    // Evasions are the moves that can answer a check, for a side in check.
+    void generateCaptures(Color color, MoveList& moves) const;
+    void generateQuiets(Color color, MoveList& moves) const;
+    void generateQuietChecks(Color color, MoveList& moves) const;
+    void generateEvasions(Color color, MoveList& moves) const;
+    
+    Color getCurrentPlayer() const { return position.state.currentPlayer; }
+    const GameState& getGameState() const { return position.state; }
+    void setGameState(const GameState& newState) { position.state = newState; }
+    const PositionSnapshot& getSnapshot() const { return position; }
+    
+    // Zobrist key of the current position (see Zobrist::hash)
+    uint64_t getKey() const;
+    
+    // Earlier occurrences of the current position with the same side to
+    // move. Only the plies since the last capture or pawn move are scanned,
+    // as no position before them can recur.
+    int repetitionCount() const;
+    bool isRepetition() const { return repetitionCount() > 0; }
+    
+    // Copies the history of `other`'s reversible window, so that a search
+    // from a history-free copy of a game position still sees its repetitions
+    void copyKeyHistory(const Board& other);
     
     void display() const;
     void setupInitialPosition();
+    void clear();
+    
+    // False, leaving the board unchanged, for malformed FENs and positions
+    // without exactly one king a side or with pawns on the back ranks.
+    // Castling rights whose king or rook is not at home are dropped.
+    bool loadFEN(const std::string& fen);
+    std::string toFEN() const;
 }; 
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "book.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <fstream>
+
+static uint64_t readBigEndian(const char* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+static void writeBigEndian(std::ostream& out, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+bool OpeningBook::open(const std::string& path) {
+    return file.open(path) && file.size() >= ENTRY_SIZE;
+}
+
+BookEntry OpeningBook::entryAt(size_t index) const {
+    const char* data = file.data() + index * ENTRY_SIZE;
+    BookEntry entry;
+    entry.key = readBigEndian(data, 8);
+    entry.move = static_cast<uint16_t>(readBigEndian(data + 8, 2));
+    entry.weight = static_cast<uint16_t>(readBigEndian(data + 10, 2));
+    entry.learn = static_cast<uint32_t>(readBigEndian(data + 12, 4));
+    return entry;
+}
+
+std::vector<BookEntry> OpeningBook::lookup(uint64_t key) const {
+    std::vector<BookEntry> entries;
+    if (!isOpen()) return entries;
+    
+    size_t low = 0, high = size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (readBigEndian(file.data() + mid * ENTRY_SIZE, 8) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (size_t i = low; i < size(); i++) {
+        BookEntry entry = entryAt(i);
+        if (entry.key != key) break;
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+uint16_t OpeningBook::encodeMove(const Move& move) {
+    int toCol = move.to.col;
+    if (move.type == MoveType::CASTLE_KINGSIDE) toCol = 7;
+    if (move.type == MoveType::CASTLE_QUEENSIDE) toCol = 0;
+    
+    int promotion = 0;
+    if (move.type == MoveType::PROMOTION) {
+        switch (move.promotionPiece) {
+            case PieceType::KNIGHT: promotion = 1; break;
+            case PieceType::BISHOP: promotion = 2; break;
+            case PieceType::ROOK: promotion = 3; break;
+            default: promotion = 4; break;
+        }
+    }
+    
+    int from = 8 * (7 - move.from.row) + move.from.col;
+    int to = 8 * (7 - move.to.row) + toCol;
+    return static_cast<uint16_t>(to | (from << 6) | (promotion << 12));
+}
+
+bool OpeningBook::probe(const Board& board, BookSelection selection, std::mt19937& rng, Move& move) const {
+    std::vector<BookEntry> entries = lookup(Zobrist::hash(board));
+    if (entries.empty()) return false;
+    
+    // Keep only entries that decode to a legal move, which guards against
+    // key collisions and books built with a different key table
+    std::vector<Move> legalMoves = board.getLegalMoves(board.getCurrentPlayer());
+    std::vector<std::pair<const Move*, uint32_t>> candidates;
+    uint32_t totalWeight = 0;
+    for (const auto& entry : entries) {
+        for (const auto& legal : legalMoves) {
+            if (encodeMove(legal) == entry.move) {
+                candidates.emplace_back(&legal, entry.weight);
+                totalWeight += entry.weight;
+                break;
+            }
+        }
+    }
+    if (candidates.empty() || totalWeight == 0) return false;
+    
+    if (selection == BookSelection::BEST) {
+        auto best = std::max_element(candidates.begin(), candidates.end(),
+                                     [](const auto& a, const auto& b) { return a.second < b.second; });
+        move = *best->first;
+        return true;
+    }
+    
+    uint32_t pick = std::uniform_int_distribution<uint32_t>(0, totalWeight - 1)(rng);
+    for (const auto& candidate : candidates) {
+        if (pick < candidate.second) {
+            move = *candidate.first;
+            return true;
+        }
+        pick -= candidate.second;
+    }
+    return false;
+}
+
+void BookBuilder::addGame(const Board& startPosition, const std::vector<Move>& moves, const std::string& result) {
+    Board board = startPosition;
+    size_t count = std::min(moves.size(), static_cast<size_t>(std::max(0, plies)));
+    
+    for (size_t i = 0; i < count; i++) {
+        bool white = board.getCurrentPlayer() == Color::WHITE;
+        uint32_t points = 1;    // draws and unfinished games
+        if (result == "1-0") points = white ? 2 : 0;
+        else if (result == "0-1") points = white ? 0 : 2;
+        
+        positions[Zobrist::hash(board)][OpeningBook::encodeMove(moves[i])] += points;
+        
+        Move move = moves[i];
+        board.makeMove(move);
+    }
+}
+
+bool BookBuilder::write(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    
+    for (const auto& position : positions) {
+        uint32_t maxWeight = 0;
+        for (const auto& move : position.second) maxWeight = std::max(maxWeight, move.second);
+        
+        // Weights are 16-bit on disk; scale down positions that overflow
+        std::vector<std::pair<uint16_t, uint16_t>> moves;
+        for (const auto& move : position.second) {
+            if (move.second == 0) continue;
+            uint64_t weight = maxWeight > 65535 ? std::max<uint64_t>(1, move.second * 65535ULL / maxWeight)
+                                                : move.second;
+            moves.emplace_back(move.first, static_cast<uint16_t>(weight));
+        }
+        std::stable_sort(moves.begin(), moves.end(),
+                         [](const auto& a, const auto& b) { return a.second > b.second; });
+        
+        for (const auto& move : moves) {
+            writeBigEndian(out, position.first, 8);
+            writeBigEndian(out, move.first, 2);
+            writeBigEndian(out, move.second, 2);
+            writeBigEndian(out, 0, 4);
+        }
+    }
+    return static_cast<bool>(out);
+}
\ No newline at end of file
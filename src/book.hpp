@@ -0,0 +1,61 @@
+#pragma once
+#include "board.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// One 16-byte Polyglot book entry (stored big-endian on disk). Moves use
+// Polyglot's encoding: bits 0-5 destination, 6-11 origin (square =
+// 8 * rank + file, rank 0 = first rank), 12-14 promotion piece (1 = knight
+// ... 4 = queen); castling is written as the king capturing its own rook.
+struct BookEntry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+    uint32_t learn;
+};
+
+enum class BookSelection { BEST, WEIGHTED };
+
+// Polyglot .bin reader. The file is memory-mapped and entries, which are
+// sorted by key, are found by binary search without loading the book.
+class OpeningBook {
+private:
+    MappedFile file;
+    
+    BookEntry entryAt(size_t index) const;
+    
+public:
+    static constexpr size_t ENTRY_SIZE = 16;
+    
+    bool open(const std::string& path);
+    bool isOpen() const { return file.isOpen(); }
+    size_t size() const { return file.size() / ENTRY_SIZE; }
+    
+    std::vector<BookEntry> lookup(uint64_t key) const;
+    
+    // Picks a legal book move for the position: the highest-weighted entry,
+    // or a random one with probability proportional to its weight.
+    bool probe(const Board& board, BookSelection selection, std::mt19937& rng, Move& move) const;
+    
+    static uint16_t encodeMove(const Move& move);
+};
+
+// Collects weighted moves from replayed games and writes a Polyglot book.
+// Each move played in the first `plies` plies of a game gets 2 points for a
+// win of the side that played it, 1 for a draw and 0 for a loss.
+class BookBuilder {
+private:
+    std::map<uint64_t, std::map<uint16_t, uint32_t>> positions;
+    int plies;
+    
+public:
+    explicit BookBuilder(int maxPlies) : plies(maxPlies) {}
+    
+    void addGame(const Board& startPosition, const std::vector<Move>& moves, const std::string& result);
+    size_t size() const { return positions.size(); }
+    bool write(const std::string& path) const;
+};
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "fuzz.hpp"
+#include "notation.hpp"
+#include "zobrist.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+
+static std::vector<uint16_t> sortedCodes(const MoveList& moves) {
+    std::vector<uint16_t> codes;
+    codes.reserve(moves.size());
+    for (const auto& move : moves) codes.push_back(packMove(move));
+    std::sort(codes.begin(), codes.end());
+    return codes;
+}
+
+static bool contains(const std::vector<uint16_t>& sorted, uint16_t code) {
+    return std::binary_search(sorted.begin(), sorted.end(), code);
+}
+
+// Names the first move in which two sorted lists differ
+static std::string difference(const char* what, const std::vector<uint16_t>& expected,
+                              const std::vector<uint16_t>& actual) {
+    size_t i = 0;
+    while (i < expected.size() && i < actual.size() && expected[i] == actual[i]) i++;
+    if (i < expected.size() && (i == actual.size() || expected[i] < actual[i])) {
+        return std::string(what) + " lacks " + moveToString(unpackMove(expected[i]));
+    }
+    return std::string(what) + " has extra " + moveToString(unpackMove(actual[i]));
+}
+
+static bool samePosition(const PositionSnapshot& a, const PositionSnapshot& b) {
+    const GameState& x = a.state;
+    const GameState& y = b.state;
+    return a.squares == b.squares && a.pieceKey == b.pieceKey && x.currentPlayer == y.currentPlayer &&
+           x.whiteCanCastleKingside == y.whiteCanCastleKingside &&
+           x.whiteCanCastleQueenside == y.whiteCanCastleQueenside &&
+           x.blackCanCastleKingside == y.blackCanCastleKingside &&
+           x.blackCanCastleQueenside == y.blackCanCastleQueenside && x.enPassantTarget == y.enPassantTarget &&
+           x.halfmoveClock == y.halfmoveClock && x.fullmoveNumber == y.fullmoveNumber;
+}
+
+// Legality by playing the move on a copy, independent of leavesKingInCheck
+static bool legalByMaking(const Board& board, const Move& move) {
+    Board after(board.getSnapshot());
+    after.makeMove(move);
+    return !after.isInCheck(board.getCurrentPlayer());
+}
+
+static bool checksByMaking(const Board& board, const Move& move) {
+    Board after(board.getSnapshot());
+    after.makeMove(move);
+    return after.isInCheck(after.getCurrentPlayer());
+}
+
+static bool isCaptureClass(const Board& board, const Move& move) {
+    return board.getPiece(move.to) || move.type == MoveType::EN_PASSANT || move.type == MoveType::PROMOTION;
+}
+
+// Drops castling rights whose king or rook is gone (unless `keepCastling`)
+// and an en passant target without the pawn that made it, so a reduced
+// position stays valid
+static void sanitize(Board& board, bool keepCastling = false) {
+    GameState state = board.getGameState();
+    auto holds = [&](int row, int col, PieceType type, Color color) {
+        uint8_t code = board.getPieceCode(row, col);
+        return code == pieceCode(type, color);
+    };
+    bool whiteKing = holds(7, 4, PieceType::KING, Color::WHITE);
+    bool blackKing = holds(0, 4, PieceType::KING, Color::BLACK);
+    if (!keepCastling) {
+        if (!whiteKing || !holds(7, 7, PieceType::ROOK, Color::WHITE)) state.whiteCanCastleKingside = false;
+        if (!whiteKing || !holds(7, 0, PieceType::ROOK, Color::WHITE)) state.whiteCanCastleQueenside = false;
+        if (!blackKing || !holds(0, 7, PieceType::ROOK, Color::BLACK)) state.blackCanCastleKingside = false;
+        if (!blackKing || !holds(0, 0, PieceType::ROOK, Color::BLACK)) state.blackCanCastleQueenside = false;
+    }
+    
+    if (state.enPassantTarget.row >= 0) {
+        Color mover = state.currentPlayer == Color::WHITE ? Color::BLACK : Color::WHITE;
+        int pawnRow = state.enPassantTarget.row + (mover == Color::WHITE ? -1 : 1);
+        if (!holds(pawnRow, state.enPassantTarget.col, PieceType::PAWN, mover)) state.enPassantTarget = Position(-1, -1);
+    }
+    board.setGameState(state);
+}
+
+std::string MoveGenFuzzer::check(const Board& board, const std::vector<uint16_t>& codes) {
+    Color side = board.getCurrentPlayer();
+    
+    if (board.getKey() != Zobrist::hash(board)) return "incremental key differs from Zobrist::hash";
+    // loadFEN drops rights the position cannot have, as sanitize() does
+    Board reloaded, sane(board.getSnapshot());
+    sanitize(sane);
+    if (!reloaded.loadFEN(board.toFEN()) || reloaded.toFEN() != sane.toFEN() ||
+        reloaded.getKey() != sane.getKey()) {
+        return "FEN round trip changes the position";
+    }
+    
+    // Reference: the virtual generators, with legality decided by making
+    MoveList referencePseudo, referenceLegal;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            const Piece* piece = board.getPiece(Position(i, j));
+            if (piece && piece->getColor() == side) piece->generateMoves(board, Position(i, j), referencePseudo);
+        }
+    }
+    for (const auto& move : referencePseudo) {
+        if (legalByMaking(board, move)) referenceLegal.push_back(move);
+    }
+    std::vector<uint16_t> pseudo = sortedCodes(referencePseudo);
+    std::vector<uint16_t> legal = sortedCodes(referenceLegal);
+    
+    MoveList moves;
+    board.generatePseudoLegalMoves(side, moves);
+    std::vector<uint16_t> generated = sortedCodes(moves);
+    if (generated != pseudo) return difference("generatePseudoLegalMoves", pseudo, generated);
+    
+    moves.clear();
+    board.generateLegalMoves(side, moves);
+    generated = sortedCodes(moves);
+    if (generated != legal) return difference("generateLegalMoves", legal, generated);
+    
+    // Staged generation: captures and quiets partition the moves
+    MoveList captures, quiets;
+    board.generateCaptures(side, captures);
+    board.generateQuiets(side, quiets);
+    for (const auto& move : captures) {
+        if (!isCaptureClass(board, move)) return "generateCaptures has quiet " + moveToString(move);
+    }
+    MoveList quietChecks;
+    for (const auto& move : quiets) {
+        if (isCaptureClass(board, move)) return "generateQuiets has capture " + moveToString(move);
+        if (checksByMaking(board, move)) quietChecks.push_back(move);
+    }
+    MoveList staged = captures;
+    staged.insert(staged.end(), quiets.begin(), quiets.end());
+    generated = sortedCodes(staged);
+    if (generated != pseudo) return difference("generateCaptures + generateQuiets", pseudo, generated);
+    
+    moves.clear();
+    board.generateQuietChecks(side, moves);
+    generated = sortedCodes(moves);
+    std::vector<uint16_t> expected = sortedCodes(quietChecks);
+    if (generated != expected) return difference("generateQuietChecks", expected, generated);
+    
+    if (board.isInCheck(side)) {
+        moves.clear();
+        board.generateEvasions(side, moves);
+        MoveList legalEvasions;
+        for (const auto& move : moves) {
+            if (!contains(pseudo, packMove(move))) return "generateEvasions has non-move " + moveToString(move);
+            if (legalByMaking(board, move)) legalEvasions.push_back(move);
+        }
+        generated = sortedCodes(legalEvasions);
+        if (generated != legal) return difference("legal generateEvasions", legal, generated);
+    }
+    
+    // Single-move validation, on every move and on arbitrary codes
+    for (uint16_t code : pseudo) {
+        if (!board.isPseudoLegal(code)) return "isPseudoLegal rejects " + moveToString(unpackMove(code));
+        if (board.isLegal(code) != contains(legal, code)) return "isLegal wrong on " + moveToString(unpackMove(code));
+    }
+    for (uint16_t code : codes) {
+        if (board.isPseudoLegal(code) != contains(pseudo, code) || board.isLegal(code) != contains(legal, code)) {
+            return "isPseudoLegal/isLegal wrong on code " + std::to_string(code);
+        }
+    }
+    
+    // Every legal move must be taken back exactly, with the key kept
+    // incrementally matching the key computed from scratch
+    Board walker(board.getSnapshot());
+    for (const auto& move : referenceLegal) {
+        walker.makeMove(move);
+        bool keyMatches = walker.getKey() == Zobrist::hash(walker);
+        walker.undoMove();
+        if (!keyMatches) return "incremental key wrong after " + moveToString(move);
+        if (!samePosition(walker.getSnapshot(), board.getSnapshot())) {
+            return "undoMove does not restore the position after " + moveToString(move);
+        }
+    }
+    return "";
+}
+
+std::string MoveGenFuzzer::minimize(const PositionSnapshot& position) {
+    Board board(position);
+    if (check(board).empty()) return board.toFEN();
+    
+    Board sane(position);
+    sanitize(sane);
+    bool keepCastling = !samePosition(sane.getSnapshot(), position);
+    
+    bool reduced = true;
+    while (reduced) {
+        reduced = false;
+        Color side = board.getCurrentPlayer();
+        Color other = side == Color::WHITE ? Color::BLACK : Color::WHITE;
+        for (int square = 0; square < 64 && !reduced; square++) {
+            uint8_t code = board.getPieceCode(square / 8, square % 8);
+            if (code == NO_PIECE || codeType(code) == PieceType::KING) continue;
+            
+            Board candidate(board.getSnapshot());
+            candidate.removePiece(Position(square / 8, square % 8));
+            sanitize(candidate, keepCastling);
+            // The side that just moved cannot be in check
+            if (candidate.isInCheck(other) || check(candidate).empty()) continue;
+            board = candidate;
+            reduced = true;
+        }
+    }
+    return board.toFEN();
+}
+
+FuzzReport MoveGenFuzzer::run() {
+    const int numThreads = std::max(1, options.threads);
+    const unsigned long long totalGames = static_cast<unsigned long long>(std::max(0, options.games));
+    
+    std::atomic<unsigned long long> nextGame(0);
+    std::atomic<bool> stop(false);
+    std::mutex mutex;
+    FuzzReport report;
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&]() {
+            std::vector<uint16_t> codes(std::max(0, options.randomCodes));
+            unsigned long long games = 0, positions = 0;
+            
+            while (!stop) {
+                unsigned long long index = nextGame++;
+                if (index >= totalGames) break;
+                std::seed_seq seed{options.seed, static_cast<unsigned int>(index),
+                                   static_cast<unsigned int>(index >> 32)};
+                std::mt19937 rng(seed);
+                
+                Board board;
+                std::vector<std::string> line;
+                for (int ply = 0; ply <= options.maxPlies && !stop; ply++) {
+                    for (auto& code : codes) code = static_cast<uint16_t>(rng() & 0xffff);
+                    std::string failure = check(board, codes);
+                    positions++;
+                    
+                    // Every fourth ply, the same position again with all
+                    // castling rights granted whether or not the king and
+                    // rooks are at home, as a careless caller could set them
+                    Board forced(board.getSnapshot());
+                    bool forcedFailure = false;
+                    if (failure.empty() && ply % 4 == 0) {
+                        GameState state = forced.getGameState();
+                        state.whiteCanCastleKingside = state.whiteCanCastleQueenside = true;
+                        state.blackCanCastleKingside = state.blackCanCastleQueenside = true;
+                        forced.setGameState(state);
+                        failure = check(forced, codes);
+                        positions++;
+                        forcedFailure = !failure.empty();
+                        if (forcedFailure) failure += " (all castling rights forced)";
+                    }
+                    if (!failure.empty()) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!report.failed) {
+                            report.failed = true;
+                            report.failure = failure;
+                            report.position = forced.getSnapshot();
+                            report.forcedCastling = forcedFailure;
+                            report.fen = forced.toFEN();
+                            report.line = line;
+                        }
+                        stop = true;
+                        break;
+                    }
+                    
+                    std::vector<Move> legalMoves = board.getLegalMoves(board.getCurrentPlayer());
+                    if (legalMoves.empty()) break;
+                    const Move& move = legalMoves[rng() % legalMoves.size()];
+                    line.push_back(moveToString(move));
+                    board.makeMove(move);
+                }
+                games++;
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            report.games += games;
+            report.positions += positions;
+        });
+    }
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (report.failed) report.minimizedFen = minimize(report.position);
+    
+    report.timeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+#include "board.hpp"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct FuzzOptions {
+    int games;
+    int threads;
+    int maxPlies;               // games still running at this length are abandoned
+    int randomCodes;            // random packed moves tested per position with isPseudoLegal
+    unsigned int seed;
+    
+    FuzzOptions() : games(1000), threads(std::max(1u, std::thread::hardware_concurrency())), maxPlies(300),
+                    randomCodes(64), seed(1) {}
+};
+
+struct FuzzReport {
+    unsigned long long games;
+    unsigned long long positions;
+    double timeSeconds;
+    
+    // The first mismatch, if any: what differed, the game that led to it
+    // and the smallest position (fewest pieces) that still shows it
+    bool failed;
+    std::string failure;
+    PositionSnapshot position;          // exactly, castling rights loadFEN would drop included
+    bool forcedCastling;                // `fen` and `minimizedFen` only fail with their castling
+                                        // field set past loadFEN, through setGameState
+    std::string fen;
+    std::vector<std::string> line;      // coordinate notation, from the initial position
+    std::string minimizedFen;
+    
+    FuzzReport() : games(0), positions(0), timeSeconds(0), failed(false), forcedCastling(false) {}
+    double positionsPerSecond() const { return timeSeconds > 0 ? positions / timeSeconds : 0; }
+};
+
+// Differential tester for the move generator. Worker threads play random
+// legal games and compare, at every ply, the board's optimized paths with
+// a reference computed independently: the virtual Piece::generateMoves
+// generators with legality decided by making the move, staged generation
+// against the full move list, isPseudoLegal/isLegal against the generated
+// moves, makeMove/undoMove against the position before, and the
+// incremental key against Zobrist::hash. The run stops at the first
+// mismatch.
+class MoveGenFuzzer {
+private:
+    FuzzOptions options;
+    
+public:
+    explicit MoveGenFuzzer(const FuzzOptions& opts) : options(opts) {}
+    
+    FuzzReport run();
+    
+    // Empty if `board` passes every check, otherwise what failed first.
+    // `codes` are extra packed moves to validate with isPseudoLegal.
+    static std::string check(const Board& board, const std::vector<uint16_t>& codes = {});
+    
+    // Removes pieces from `position` one at a time, keeping each removal
+    // after which check() still fails, and returns the resulting FEN. A
+    // position with castling rights its king and rooks cannot have keeps
+    // them, since loading its FEN would drop them and hide the failure.
+    static std::string minimize(const PositionSnapshot& position);
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "game.hpp"
 #include "player.hpp"
+#include "notation.hpp"
+#include "pgn.hpp"
 #include <iostream>
 #include <string>
 #include <algorithm>
@@ -11,71 +13,6 @@ void Game::setPlayers(std::unique_ptr<Player> white, std::unique_ptr<Player> bla
     blackPlayer = std::move(black);
 }
 
-Position Game::parsePosition(const std::string& posStr) const {
-    if (posStr.length() != 2) return Position(-1, -1);
-    
-    char file = posStr[0];
-    char rank = posStr[1];
-    
-    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') {
-        return Position(-1, -1);
-    }
-    
-    return Position(8 - (rank - '0'), file - 'a');
-}
-
-std::string Game::positionToString(const Position& pos) const {
-    if (pos.row < 0 || pos.row >= 8 || pos.col < 0 || pos.col >= 8) {
-        return "";
-    }
-    
-    char file = 'a' + pos.col;
-    char rank = '8' - pos.row;
-    
-    return std::string(1, file) + std::string(1, rank);
-}
-
-bool Game::parseMove(const std::string& moveStr, Move& move) const {
-    if (moveStr.length() < 4 || moveStr.length() > 5) return false;
-    
-    Position from = parsePosition(moveStr.substr(0, 2));
-    Position to = parsePosition(moveStr.substr(2, 2));
-    
-    if (from.row == -1 || to.row == -1) return false;
-    
-    move = Move(from, to);
-    
-    if (moveStr.length() == 5) {
-        char promotion = moveStr[4];
-        switch (promotion) {
-            case 'q': case 'Q': move.promotionPiece = PieceType::QUEEN; break;
-            case 'r': case 'R': move.promotionPiece = PieceType::ROOK; break;
-            case 'b': case 'B': move.promotionPiece = PieceType::BISHOP; break;
-            case 'n': case 'N': move.promotionPiece = PieceType::KNIGHT; break;
-            default: return false;
-        }
-        move.type = MoveType::PROMOTION;
-    }
-    
-    return true;
-}
-
-std::string Game::moveToString(const Move& move) const {
-    std::string result = positionToString(move.from) + positionToString(move.to);
-    
-    if (move.type == MoveType::PROMOTION) {
-        switch (move.promotionPiece) {
-            case PieceType::QUEEN: result += 'q'; break;
-            case PieceType::ROOK: result += 'r'; break;
-            case PieceType::BISHOP: result += 'b'; break;
-            case PieceType::KNIGHT: result += 'n'; break;
-            default: result += 'q'; break;
-        }
-    }
-    
-    return result;
-}
-
 void Game::displayBoard() const {
     board.display();
 }
@@ -102,15 +39,68 @@ void Game::displayGameInfo() const {
     }
 }
 
+void Game::writePGN(std::ostream& out) const {
+    std::string resultStr = resultToken(result);
+    
+    std::vector<std::pair<std::string, std::string>> tags = {
+        {"Event", "Checkmate++ game"}, {"Site", "?"}, {"Date", "????.??.??"}, {"Round", "-"},
+        {"White", "?"}, {"Black", "?"}, {"Result", resultStr}
+    };
+    
+    PgnWriter writer(out);
+    writer.writeGame(tags, Board(), moves, resultStr);
+}
+
+const char* resultToken(GameResult result) {
+    switch (result) {
+        case GameResult::WHITE_WINS: return "1-0";
+        case GameResult::BLACK_WINS: return "0-1";
+        case GameResult::DRAW: return "1/2-1/2";
+        default: return "*";
+    }
+}
+
+GameResult resultByRule(const Board& board) {
+    Color toMove = board.getCurrentPlayer();
+    if (!board.hasLegalMoves(toMove)) {
+        if (!board.isInCheck(toMove)) return GameResult::DRAW;
+        return (toMove == Color::WHITE) ? GameResult::BLACK_WINS : GameResult::WHITE_WINS;
+    }
+    if (board.getGameState().halfmoveClock >= 100 || board.repetitionCount() >= 2 ||
+        board.isInsufficientMaterial()) {
+        return GameResult::DRAW;
+    }
+    return GameResult::ONGOING;
+}
+
+GameResult resultByTablebase(const Tablebase& tables, const Board& board) {
+    TablebaseResult probed;
+    if (!tables.probe(board, probed)) return GameResult::ONGOING;
+    if (probed.wdl == 0) return GameResult::DRAW;
+    bool whiteWins = (probed.wdl > 0) == (board.getCurrentPlayer() == Color::WHITE);
+    return whiteWins ? GameResult::WHITE_WINS : GameResult::BLACK_WINS;
+}
+
 void Game::playMove(const Move& move) {
     if (board.makeMove(move)) {
-        Color currentPlayer = board.getCurrentPlayer();
-        
-        if (board.isCheckmate(currentPlayer)) {
-            result = (currentPlayer == Color::WHITE) ? GameResult::BLACK_WINS : GameResult::WHITE_WINS;
-        } else if (board.isStalemate(currentPlayer)) {
-            result = GameResult::DRAW;
-        }
+        moves.push_back(move);
+        result = resultByRule(board);
+    }
+}
+
+// Coordinate input (e1g1, e7e8) does not say which kind of move it is, so
+// castling, en passant and promotion are told apart by the moving piece.
+// A promotion without a piece letter promotes to a queen.
+static void completeMoveType(const Board& board, Move& move) {
+    const Piece* piece = board.getPiece(move.from);
+    if (!piece || move.type != MoveType::NORMAL) return;
+    
+    int deltaCol = move.to.col - move.from.col;
+    if (piece->getType() == PieceType::KING && move.from.row == move.to.row && (deltaCol == 2 || deltaCol == -2)) {
+        move.type = deltaCol > 0 ? MoveType::CASTLE_KINGSIDE : MoveType::CASTLE_QUEENSIDE;
+    } else if (piece->getType() == PieceType::PAWN) {
+        if (move.to.row == 0 || move.to.row == 7) move.type = MoveType::PROMOTION;
+        else if (deltaCol != 0 && !board.getPiece(move.to)) move.type = MoveType::EN_PASSANT;
     }
 }
 
@@ -121,7 +111,7 @@ void Game::run() {
     }
     
     std::cout << "Checkmate++ Chess Engine\n";
-    std::cout << "Enter moves in format: e2e4 (from-to)\n";
+    std::cout << "Enter moves in format: e2e4 (from-to) or SAN (e4, Nf3, O-O)\n";
     std::cout << "Type 'quit' to exit\n\n";
     
     while (result == GameResult::ONGOING) {
@@ -133,27 +123,10 @@ void Game::run() {
         try {
             Move move = currentPlayer->getMove(board);
             
-            std::vector<Move> legalMoves = board.getLegalMoves(board.getCurrentPlayer());
-            bool isLegal = false;
-            
-            for (const auto& legalMove : legalMoves) {
-                if (move.from == legalMove.from && move.to == legalMove.to) {
-                    if (move.type == MoveType::PROMOTION) {
-                        if (legalMove.type == MoveType::PROMOTION) {
-                            move.type = legalMove.type;
-                            isLegal = true;
-                            break;
-                        }
-                    } else {
-                        move.type = legalMove.type;
-                        isLegal = true;
-                        break;
-                    }
-                }
-            }
+            completeMoveType(board, move);
             
-            if (isLegal) {
-                std::cout << "Move: " << moveToString(move) << "\n\n";
+            if (board.isLegal(packMove(move))) {
+                std::cout << "Move: " << moveToSAN(board, move) << "\n\n";
                 playMove(move);
             } else {
                 std::cout << "Illegal move!\n";
@@ -164,6 +137,12 @@ void Game::run() {
         }
     }
     
+    whitePlayer->stopThinking();
+    blackPlayer->stopThinking();
+    
     displayBoard();
     displayGameInfo();
-} 
\ No newline at end of file
+    
+    std::cout << "\nGame record:\n";
+    writePGN(std::cout);
+}
\ No newline at end of file
@@ -1,22 +1,31 @@
 #pragma once
 #include "board.hpp"
 #include "player.hpp"
+#include <iostream>
 #include <memory>
+#include <vector>
 
 enum class GameResult { ONGOING, WHITE_WINS, BLACK_WINS, DRAW };
 
+// PGN result token: "1-0", "0-1", "1/2-1/2" or "*"
+const char* resultToken(GameResult result);
+
+// Result of a position in which the game is over by rule (mate, stalemate,
+// the fifty-move rule, threefold repetition or insufficient material),
+// ONGOING otherwise.
+GameResult resultByRule(const Board& board);
+
+// Result of a position found in the tablebases, ONGOING when it is not
+GameResult resultByTablebase(const Tablebase& tables, const Board& board);
+
 class Game {
 private:
     Board board;
+    std::vector<Move> moves;            // the whole game, for PGN; the board keeps only recent plies
     std::unique_ptr<Player> whitePlayer;
     std::unique_ptr<Player> blackPlayer;
     GameResult result;
     
-    bool parseMove(const std::string& moveStr, Move& move) const;
-    std::string moveToString(const Move& move) const;
-    Position parsePosition(const std::string& posStr) const;
-    std::string positionToString(const Position& pos) const;
-    
 public:
     Game();
     
@@ -29,4 +38,5 @@ public:
     
     void displayBoard() const;
     void displayGameInfo() const;
+    void writePGN(std::ostream& out) const;
 }; 
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "instrument.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+struct TraceEvent {
+    Probe probe;
+    int thread;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// Call tree of one thread since its last flush. Node 0 is the root.
+struct ThreadProfile {
+    struct Node {
+        Probe probe;
+        int parent;
+        std::array<int, PROBE_COUNT> children;
+        uint64_t inclusiveNs;
+        uint64_t calls;
+    };
+    
+    std::vector<Node> nodes;
+    int current;
+    int thread;
+    std::array<uint64_t, COUNTER_COUNT> counters;
+    std::vector<TraceEvent> events;
+    
+    ThreadProfile() : current(0), thread(nextThread++) { reset(); }
+    
+    void reset() {
+        Node root;
+        root.probe = Probe::COUNT;
+        root.parent = -1;
+        root.children.fill(-1);
+        root.inclusiveNs = root.calls = 0;
+        nodes.assign(1, root);
+        current = 0;
+        counters.fill(0);
+        events.clear();
+    }
+    
+    static std::atomic<int> nextThread;
+};
+
+std::atomic<int> ThreadProfile::nextThread(0);
+
+static thread_local ThreadProfile profile;
+
+// Everything flushed so far, from every thread
+struct Profile {
+    std::mutex mutex;
+    std::string output;
+    std::map<std::string, std::pair<uint64_t, uint64_t>> stacks;   // path -> self ns, calls
+    std::array<uint64_t, COUNTER_COUNT> counters{};
+    std::vector<TraceEvent> events;
+    uint64_t droppedEvents = 0;
+    bool traceWritten = false;
+};
+
+static Profile& global() {
+    static Profile instance;
+    return instance;
+}
+
+static bool wantsTrace(const std::string& path) {
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+}
+
+static void writeFolded(const Profile& merged) {
+    std::ofstream out(merged.output);
+    for (const auto& stack : merged.stacks) {
+        if (stack.second.first > 0) out << stack.first << ' ' << stack.second.first << '\n';
+    }
+}
+
+static void writeTrace(const Profile& merged) {
+    std::ofstream out(merged.output);
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < merged.events.size(); i++) {
+        const TraceEvent& event = merged.events[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":\"" << Instrumentation::name(event.probe)
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << std::fixed << std::setprecision(3)
+            << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << merged.droppedEvents;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        out << ",\"" << Instrumentation::name(static_cast<Counter>(i)) << "\":" << merged.counters[i];
+    }
+    out << "}}\n";
+}
+
+const char* Instrumentation::name(Probe probe) {
+    switch (probe) {
+        case Probe::SEARCH: return "search";
+        case Probe::QUIESCENCE: return "quiescence";
+        case Probe::MOVE_GENERATION: return "movegen";
+        case Probe::MAKE_MOVE: return "makeMove";
+        case Probe::UNDO_MOVE: return "undoMove";
+        case Probe::EVALUATE: return "evaluate";
+        case Probe::TT_PROBE: return "ttProbe";
+        case Probe::TT_STORE: return "ttStore";
+        case Probe::LEGALITY: return "legality";
+        default: return "?";
+    }
+}
+
+const char* Instrumentation::name(Counter counter) {
+    switch (counter) {
+        case Counter::TT_HITS: return "ttHits";
+        case Counter::TT_MISSES: return "ttMisses";
+        case Counter::CUTOFFS: return "cutoffs";
+        case Counter::ILLEGAL_MOVES: return "illegalMoves";
+        default: return "?";
+    }
+}
+
+uint64_t Instrumentation::now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+bool Instrumentation::enter(Probe probe) {
+    ThreadProfile& p = profile;
+    if (p.nodes[p.current].probe == probe) return false;
+    
+    int child = p.nodes[p.current].children[static_cast<int>(probe)];
+    if (child < 0) {
+        ThreadProfile::Node node;
+        node.probe = probe;
+        node.parent = p.current;
+        node.children.fill(-1);
+        node.inclusiveNs = node.calls = 0;
+        child = static_cast<int>(p.nodes.size());
+        p.nodes.push_back(node);
+        p.nodes[p.current].children[static_cast<int>(probe)] = child;
+    }
+    p.nodes[child].calls++;
+    p.current = child;
+    return true;
+}
+
+void Instrumentation::leave(Probe probe, uint64_t startNs, uint64_t endNs) {
+    ThreadProfile& p = profile;
+    ThreadProfile::Node& node = p.nodes[p.current];
+    node.inclusiveNs += endNs - startNs;
+    p.current = node.parent;
+    if (p.events.size() < MAX_TRACE_EVENTS) p.events.push_back(TraceEvent{probe, p.thread, startNs, endNs - startNs});
+}
+
+void Instrumentation::count(Counter counter) {
+    profile.counters[static_cast<int>(counter)]++;
+}
+
+void Instrumentation::setOutput(const std::string& path) {
+    std::lock_guard<std::mutex> lock(global().mutex);
+    global().output = path;
+}
+
+void Instrumentation::flush() {
+    if (!ENABLED) return;
+    ThreadProfile& p = profile;
+    if (p.current != 0) return;         // inside a scope; its caller flushes
+    
+    Profile& merged = global();
+    std::lock_guard<std::mutex> lock(merged.mutex);
+    for (size_t i = 1; i < p.nodes.size(); i++) {
+        const ThreadProfile::Node& node = p.nodes[i];
+        uint64_t childNs = 0;
+        for (int child : node.children) {
+            if (child >= 0) childNs += p.nodes[child].inclusiveNs;
+        }
+        std::string path = name(node.probe);
+        for (int parent = node.parent; parent > 0; parent = p.nodes[parent].parent) {
+            path = std::string(name(p.nodes[parent].probe)) + ";" + path;
+        }
+        auto& stack = merged.stacks[path];
+        stack.first += node.inclusiveNs - std::min(childNs, node.inclusiveNs);
+        stack.second += node.calls;
+    }
+    for (int i = 0; i < COUNTER_COUNT; i++) merged.counters[i] += p.counters[i];
+    
+    bool trace = wantsTrace(merged.output);
+    size_t room = MAX_TRACE_EVENTS - std::min(MAX_TRACE_EVENTS, merged.events.size());
+    size_t kept = trace ? std::min(room, p.events.size()) : 0;
+    merged.events.insert(merged.events.end(), p.events.begin(), p.events.begin() + kept);
+    merged.droppedEvents += p.events.size() - kept;
+    p.reset();
+    
+    // A full trace does not change any more, apart from the counters
+    if (merged.output.empty()) return;
+    if (!trace) writeFolded(merged);
+    else if (kept > 0 || !merged.traceWritten) writeTrace(merged);
+    merged.traceWritten = merged.traceWritten || trace;
+}
+
+std::string Instrumentation::summary() {
+    if (!ENABLED) return "";
+    Profile& merged = global();
+    std::lock_guard<std::mutex> lock(merged.mutex);
+    
+    std::array<uint64_t, PROBE_COUNT> selfNs{}, calls{};
+    for (const auto& stack : merged.stacks) {
+        const std::string& path = stack.first;
+        size_t separator = path.rfind(';');
+        std::string leaf = separator == std::string::npos ? path : path.substr(separator + 1);
+        for (int i = 0; i < PROBE_COUNT; i++) {
+            if (leaf == name(static_cast<Probe>(i))) {
+                selfNs[i] += stack.second.first;
+                calls[i] += stack.second.second;
+            }
+        }
+    }
+    
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        if (calls[i] == 0) continue;
+        out << "  " << std::left << std::setw(12) << name(static_cast<Probe>(i)) << std::right << std::setw(12)
+            << calls[i] << " calls " << std::setw(10) << selfNs[i] / 1e6 << " ms self\n";
+    }
+    out << " ";
+    for (int i = 0; i < COUNTER_COUNT; i++) out << " " << name(static_cast<Counter>(i)) << " " << merged.counters[i];
+    out << "\n";
+    return out.str();
+}
\ No newline at end of file
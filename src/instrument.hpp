@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Hot-path instrumentation, compiled in by building with -DINSTRUMENT
+// (make instrument). In other builds the macros below expand to nothing.
+//
+// INSTRUMENT_SCOPE(probe) times the rest of the enclosing block and
+// INSTRUMENT_COUNT(counter) bumps a counter, both into tables of the
+// calling thread. Scopes nest into a call tree; a probe entered again
+// directly inside itself (the recursive search) is folded into the outer
+// scope. INSTRUMENT_FLUSH() at the end of a search merges the thread's
+// tables into the process-wide profile and rewrites the output file.
+
+enum class Probe : uint8_t {
+    SEARCH,
+    QUIESCENCE,
+    MOVE_GENERATION,
+    MAKE_MOVE,
+    UNDO_MOVE,
+    EVALUATE,
+    TT_PROBE,
+    TT_STORE,
+    LEGALITY,
+    COUNT
+};
+
+enum class Counter : uint8_t {
+    TT_HITS,
+    TT_MISSES,
+    CUTOFFS,
+    ILLEGAL_MOVES,              // generated moves the search skipped as illegal
+    COUNT
+};
+
+constexpr int PROBE_COUNT = static_cast<int>(Probe::COUNT);
+constexpr int COUNTER_COUNT = static_cast<int>(Counter::COUNT);
+
+class Instrumentation {
+public:
+#ifdef INSTRUMENT
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+    
+    // Maximum number of scopes kept for a Chrome trace, over the whole run
+    static constexpr size_t MAX_TRACE_EVENTS = 200000;
+    
+    // Where flush() writes the profile: a Chrome trace (chrome://tracing,
+    // Perfetto) if the path ends in ".json", otherwise folded stacks with
+    // self time in nanoseconds, the input of flamegraph.pl and speedscope.
+    // Empty (the default) keeps the profile in memory only.
+    static void setOutput(const std::string& path);
+    
+    static void flush();
+    
+    // Per-probe calls and self time, and the counters, of the profile
+    // flushed so far
+    static std::string summary();
+    
+    static const char* name(Probe probe);
+    static const char* name(Counter counter);
+    
+    static bool enter(Probe probe);
+    static void leave(Probe probe, uint64_t startNs, uint64_t endNs);
+    static void count(Counter counter);
+    static uint64_t now();
+};
+
+#ifdef INSTRUMENT
+class ScopedProbe {
+private:
+    Probe probe;
+    bool active;                        // false when folded into an enclosing scope
+    uint64_t start;
+    
+public:
+    explicit ScopedProbe(Probe p) : probe(p), active(Instrumentation::enter(p)), start(Instrumentation::now()) {}
+    ~ScopedProbe() {
+        if (active) Instrumentation::leave(probe, start, Instrumentation::now());
+    }
+    ScopedProbe(const ScopedProbe&) = delete;
+    ScopedProbe& operator=(const ScopedProbe&) = delete;
+};
+
+#define INSTRUMENT_JOIN2(a, b) a##b
+#define INSTRUMENT_JOIN(a, b) INSTRUMENT_JOIN2(a, b)
+#define INSTRUMENT_SCOPE(probe) ScopedProbe INSTRUMENT_JOIN(scopedProbe, __LINE__)(Probe::probe)
+#define INSTRUMENT_COUNT(counter) Instrumentation::count(Counter::counter)
+#define INSTRUMENT_FLUSH() Instrumentation::flush()
+#else
+#define INSTRUMENT_SCOPE(probe) ((void)0)
+#define INSTRUMENT_COUNT(counter) ((void)0)
+#define INSTRUMENT_FLUSH() ((void)0)
+#endif
\ No newline at end of file
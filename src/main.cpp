@@ -1,7 +1,24 @@
 #include "game.hpp"
 #include "player.hpp"
+#include "analysis.hpp"
+#include "pgn.hpp"
+#include "binary_format.hpp"
+#include "selfplay.hpp"
+#include "fuzz.hpp"
+#include "match.hpp"
+#include "book.hpp"
+#include "zobrist.hpp"
+#include "tablebase.hpp"
+#include "instrument.hpp"
+#include "numa.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
 
 void displayMenu() {
     std::cout << "\n~~~~~~ Checkmate++ Chess Engine ~~~~~~\n";
@@ -21,7 +38,541 @@ int getAIDifficulty() {
     return std::max(1, std::min(5, difficulty));
 }
 
-int main() {
+void displayUsage() {
+    std::cout << "Usage: checkmate++ [mode]\n";
+    std::cout << "  (no arguments)          Interactive game menu\n";
+    std::cout << "  --polyglot <file.bin>   AI players of the game menu use the opening book\n";
+    std::cout << "      --book-best         Always play the highest-weighted book move\n";
+    std::cout << "  --ponder                AI players of the game menu think on the opponent's time\n";
+    std::cout << "  --make-book <file|->    Build a Polyglot book from a PGN archive\n";
+    std::cout << "      --output <file.bin> Book file to write\n";
+    std::cout << "      --book-plies N      Plies of each game to include (default 20)\n";
+    std::cout << "  --book-keys <file>      Replace the built-in Polyglot Random64 key table with\n";
+    std::cout << "                          781 hex values from <file>\n";
+    std::cout << "  --tb-path <dirs>        Probe the Syzygy tablebases in <dirs>, separated by ':' (any mode)\n";
+    std::cout << "      --tb-probe-depth N  Minimum remaining depth for probes in the search (default 1)\n";
+    std::cout << "  --hash MB               Transposition table size per searching thread (default 4)\n";
+    std::cout << "      --pages small|transparent|explicit  Page backing of the tables (default transparent)\n";
+    std::cout << "      --bind none|cores|nodes  Pin the search workers and the threads clearing a table\n";
+    std::cout << "  --profile <file>        Write the search profile of a `make instrument` build to\n";
+    std::cout << "                          <file>: Chrome trace JSON if it ends in .json, else folded stacks\n";
+    std::cout << "  --batch <file|->        Analyze FEN/EPD positions, one per line\n";
+    std::cout << "      --depth N           Search depth (default 3)\n";
+    std::cout << "      --threads N         Worker threads (default: all cores)\n";
+    std::cout << "      --multipv K         Report the best K lines with their principal variations\n";
+    std::cout << "      --format csv|jsonl|bin  Output format (default csv; bin = packed positions)\n";
+    std::cout << "      --output <file>     Write results to a file instead of stdout\n";
+    std::cout << "  --pgn <file|->          Parse and replay a PGN archive\n";
+    std::cout << "      --output <file>     Re-emit the replayed games as normalized PGN\n";
+    std::cout << "      --games-out <file>  Store the replayed games in the binary game format\n";
+    std::cout << "  --selfplay <file>       Generate self-play training positions (binary format)\n";
+    std::cout << "      --games N           Number of games (default 100)\n";
+    std::cout << "      --threads N         Concurrent games (default: all cores)\n";
+    std::cout << "      --depth N           Search depth per move (default 2)\n";
+    std::cout << "      --book <file.pgn>   Start from random book lines (first --book-plies plies)\n";
+    std::cout << "      --random-plies N    Random plies after the book line (default 8)\n";
+    std::cout << "      --max-plies N       Adjudicate longer games as draws (default 400)\n";
+    std::cout << "      --resign-score N    Adjudicate a win at |score| >= N held --resign-plies plies\n";
+    std::cout << "      --seed N            Random seed (default 1)\n";
+    std::cout << "      --games-out <file>  Also store the games in the binary game format\n";
+    std::cout << "  --verify <file.bin>     Reload a position or game file, checking every record\n";
+    std::cout << "      --output <file>     Dump positions as CSV or games as PGN\n";
+    std::cout << "  --fuzz                  Compare the move generator with the reference in random games\n";
+    std::cout << "      --games N           Number of games (default 1000)\n";
+    std::cout << "      --threads N         Concurrent games (default: all cores)\n";
+    std::cout << "      --max-plies N       Plies per game (default 300)\n";
+    std::cout << "      --seed N            Random seed (default 1)\n";
+    std::cout << "  --match <spec> <spec>   Play two configurations, e.g. depth=3 movetime=100,depth=20\n";
+    std::cout << "      --games N           Maximum number of games (default 1000)\n";
+    std::cout << "      --threads N         Concurrent game pairs (default: all cores)\n";
+    std::cout << "      --elo0 X --elo1 Y   SPRT hypotheses in Elo (default 0 and 10)\n";
+    std::cout << "      --alpha A --beta B  SPRT error rates (default 0.05)\n";
+    std::cout << "      --no-sprt           Play all games without early stopping\n";
+    std::cout << "      --book <file.pgn>   Opening lines; --random-plies N random plies (default 8)\n";
+}
+
+std::string getOption(const std::vector<std::string>& args, const std::string& name, const std::string& fallback) {
+    for (size_t i = 0; i + 1 < args.size(); i++) {
+        if (args[i] == name) return args[i + 1];
+    }
+    return fallback;
+}
+
+int runBatchMode(const std::vector<std::string>& args, const TablebaseConfig& tablebase,
+                 const PlacementConfig& placement) {
+    AnalysisOptions options;
+    options.tablebase = tablebase;
+    options.placement = placement;
+    options.depth = std::max(1, std::stoi(getOption(args, "--depth", std::to_string(options.depth))));
+    options.threads = std::max(1, std::stoi(getOption(args, "--threads", std::to_string(options.threads))));
+    options.multiPV = std::max(1, std::stoi(getOption(args, "--multipv", std::to_string(options.multiPV))));
+    
+    std::string format = getOption(args, "--format", "csv");
+    if (format == "jsonl") {
+        options.format = OutputFormat::JSONL;
+    } else if (format == "bin") {
+        options.format = OutputFormat::BINARY;
+    } else if (format != "csv") {
+        std::cerr << "Unknown format: " << format << "\n";
+        return 1;
+    }
+    
+    std::string inputPath = getOption(args, "--batch", "-");
+    std::ifstream inputFile;
+    if (inputPath != "-") {
+        inputFile.open(inputPath);
+        if (!inputFile) {
+            std::cerr << "Cannot open " << inputPath << "\n";
+            return 1;
+        }
+    }
+    
+    std::string outputPath = getOption(args, "--output", "-");
+    std::ofstream outputFile;
+    if (outputPath != "-") {
+        outputFile.open(outputPath);
+        if (!outputFile) {
+            std::cerr << "Cannot write " << outputPath << "\n";
+            return 1;
+        }
+    }
+    
+    BatchAnalyzer analyzer(options);
+    AnalysisStats stats = analyzer.run(inputPath == "-" ? std::cin : inputFile,
+                                       outputPath == "-" ? std::cout : outputFile);
+    
+    std::cerr << "Analyzed " << stats.positions << " positions (" << stats.failed << " skipped) in "
+              << stats.timeSeconds << "s using " << options.threads << " threads: "
+              << stats.positionsPerSecond() << " positions/s, "
+              << (stats.timeSeconds > 0 ? stats.nodes / stats.timeSeconds : 0) << " nodes/s\n";
+    return 0;
+}
+
+int runPgnMode(const std::vector<std::string>& args) {
+    std::string outputPath = getOption(args, "--output", "");
+    std::ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(outputPath);
+        if (!outputFile) {
+            std::cerr << "Cannot write " << outputPath << "\n";
+            return 1;
+        }
+    }
+    
+    std::unique_ptr<GameWriter> gameWriter;
+    std::string gamesPath = getOption(args, "--games-out", "");
+    if (!gamesPath.empty()) {
+        gameWriter = std::make_unique<GameWriter>(gamesPath);
+        if (!gameWriter->isOpen()) {
+            std::cerr << "Cannot write " << gamesPath << "\n";
+            return 1;
+        }
+    }
+    
+    PgnWriter writer(outputFile);
+    unsigned long long plies = 0;
+    PgnReplayer replayer([&](const PgnGame& game) {
+        plies += game.moves.size();
+        if (!game.error.empty()) {
+            std::cerr << "Skipping game: " << game.error << "\n";
+            return;
+        }
+        if (outputFile.is_open()) {
+            writer.writeGame(game);
+        }
+        if (gameWriter) {
+            GameResult result = GameResult::ONGOING;
+            if (game.result == "1-0") result = GameResult::WHITE_WINS;
+            else if (game.result == "0-1") result = GameResult::BLACK_WINS;
+            else if (game.result == "1/2-1/2") result = GameResult::DRAW;
+            gameWriter->write(game.startPosition, game.moves, result);
+        }
+    });
+    
+    PgnReader reader(replayer);
+    std::string inputPath = getOption(args, "--pgn", "-");
+    if (inputPath == "-") {
+        reader.readStream(std::cin);
+    } else if (!reader.readFile(inputPath)) {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+    
+    const PgnStats& stats = reader.getStats();
+    std::cerr << "Replayed " << stats.games << " games (" << replayer.getErrorCount() << " with errors, "
+              << plies << " plies) in " << stats.timeSeconds << "s: "
+              << stats.megabytesPerSecond() << " MB/s, " << stats.gamesPerSecond() << " games/s\n";
+    return 0;
+}
+
+int runSelfPlayMode(const std::vector<std::string>& args, const TablebaseConfig& tablebase,
+                    const PlacementConfig& placement) {
+    SelfPlayOptions options;
+    options.tablebase = tablebase;
+    options.placement = placement;
+    auto intOption = [&](const std::string& name, int fallback) {
+        return std::stoi(getOption(args, name, std::to_string(fallback)));
+    };
+    options.games = std::max(0, intOption("--games", options.games));
+    options.threads = std::max(1, intOption("--threads", options.threads));
+    options.depth = std::max(1, intOption("--depth", options.depth));
+    options.bookPlies = std::max(0, intOption("--book-plies", options.bookPlies));
+    options.randomPlies = std::max(0, intOption("--random-plies", options.randomPlies));
+    options.maxPlies = std::max(1, intOption("--max-plies", options.maxPlies));
+    options.resignScore = intOption("--resign-score", options.resignScore);
+    options.resignPlies = std::max(1, intOption("--resign-plies", options.resignPlies));
+    options.seed = static_cast<unsigned int>(intOption("--seed", options.seed));
+    
+    SelfPlayGenerator generator(options);
+    std::string bookPath = getOption(args, "--book", "");
+    if (!bookPath.empty()) {
+        if (!generator.loadBook(bookPath)) {
+            std::cerr << "Cannot open " << bookPath << "\n";
+            return 1;
+        }
+        std::cerr << "Loaded " << generator.getBookSize() << " book lines\n";
+    }
+    
+    std::string outputPath = getOption(args, "--selfplay", "");
+    PositionWriter positions(outputPath);
+    if (!positions.isOpen()) {
+        std::cerr << "Cannot write " << outputPath << "\n";
+        return 1;
+    }
+    
+    std::unique_ptr<GameWriter> gameWriter;
+    std::string gamesPath = getOption(args, "--games-out", "");
+    if (!gamesPath.empty()) {
+        gameWriter = std::make_unique<GameWriter>(gamesPath);
+        if (!gameWriter->isOpen()) {
+            std::cerr << "Cannot write " << gamesPath << "\n";
+            return 1;
+        }
+    }
+    
+    SelfPlayStats stats = generator.run(positions, gameWriter.get());
+    std::cerr << "Played " << stats.games << " games (+" << stats.whiteWins << " -" << stats.blackWins
+              << " =" << stats.draws << ", " << stats.adjudicated << " adjudicated) in " << stats.timeSeconds
+              << "s using " << options.threads << " threads: " << stats.gamesPerSecond() << " games/s, "
+              << stats.positionsPerSecond() << " positions/s, "
+              << (stats.timeSeconds > 0 ? stats.nodes / stats.timeSeconds : 0) << " nodes/s\n";
+    std::cerr << "Wrote " << stats.positions << " positions to " << outputPath << "\n";
+    return 0;
+}
+
+// Reloads a position or game file, whichever it is, checks every position
+// and replays every game, optionally dumping them as CSV or PGN
+int runVerifyMode(const std::vector<std::string>& args) {
+    std::string inputPath = getOption(args, "--verify", "");
+    std::string outputPath = getOption(args, "--output", "");
+    std::ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(outputPath);
+        if (!outputFile) {
+            std::cerr << "Cannot write " << outputPath << "\n";
+            return 1;
+        }
+    }
+    
+    // A valid record unpacks to a position loadFEN accepts and packs back
+    // to the same bytes
+    auto unpackValid = [](const PackedPosition& packed, Board& board) {
+        Board reloaded;
+        if (packed.result > static_cast<uint8_t>(GameResult::DRAW) || !unpackPosition(packed, board) ||
+            !reloaded.loadFEN(board.toFEN())) {
+            return false;
+        }
+        PackedPosition repacked = packPosition(board, packed.score, static_cast<GameResult>(packed.result));
+        return std::memcmp(&repacked, &packed, sizeof(packed)) == 0;
+    };
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    PositionReader positions;
+    if (positions.open(inputPath)) {
+        unsigned long long invalid = 0;
+        if (outputFile.is_open()) outputFile << "fen,score,result\n";
+        for (size_t i = 0; i < positions.size(); i++) {
+            PackedPosition packed = positions[i];
+            Board board;
+            if (!unpackValid(packed, board)) {
+                if (invalid++ < 10) std::cerr << "Invalid position record " << i << "\n";
+                continue;
+            }
+            if (outputFile.is_open()) {
+                outputFile << board.toFEN() << ',' << packed.score << ','
+                           << resultToken(static_cast<GameResult>(packed.result)) << '\n';
+            }
+        }
+        std::cerr << "Verified " << positions.size() << " positions (" << invalid << " invalid) in "
+                  << elapsed() << "s\n";
+        return invalid == 0 ? 0 : 1;
+    }
+    
+    GameReader games;
+    if (!games.open(inputPath)) {
+        std::cerr << "Cannot read " << inputPath << " as a position or game file\n";
+        return 1;
+    }
+    PgnWriter writer(outputFile);
+    unsigned long long count = 0, invalid = 0, plies = 0;
+    GameView game;
+    while (games.next(game)) {
+        Board startPosition;
+        bool valid = unpackValid(game.start, startPosition);
+        
+        // Every stored move must be legal where it is played
+        Board board = startPosition;
+        std::vector<Move> moves;
+        for (size_t i = 0; valid && i < game.moveCount; i++) {
+            uint16_t code = game.moveAt(i);
+            valid = board.isLegal(code);
+            if (!valid) break;
+            moves.push_back(unpackMove(code));
+            board.makeMove(moves.back());
+        }
+        count++;
+        plies += moves.size();
+        if (!valid) {
+            if (invalid++ < 10) std::cerr << "Invalid game " << count << " after " << moves.size() << " moves\n";
+            continue;
+        }
+        
+        if (outputFile.is_open()) {
+            std::vector<std::pair<std::string, std::string>> tags;
+            if (startPosition.toFEN() != Board().toFEN()) {
+                tags.emplace_back("SetUp", "1");
+                tags.emplace_back("FEN", startPosition.toFEN());
+            }
+            writer.writeGame(tags, startPosition, moves, resultToken(game.result()));
+        }
+    }
+    double seconds = elapsed();
+    std::cerr << "Verified " << count << " games (" << invalid << " invalid, " << plies << " plies) in " << seconds
+              << "s: " << (seconds > 0 ? count / seconds : 0) << " games/s\n";
+    return invalid == 0 ? 0 : 1;
+}
+
+int runFuzzMode(const std::vector<std::string>& args) {
+    FuzzOptions options;
+    auto intOption = [&](const std::string& name, int fallback) {
+        return std::stoi(getOption(args, name, std::to_string(fallback)));
+    };
+    options.games = std::max(1, intOption("--games", options.games));
+    options.threads = std::max(1, intOption("--threads", options.threads));
+    options.maxPlies = std::max(1, intOption("--max-plies", options.maxPlies));
+    options.seed = static_cast<unsigned int>(intOption("--seed", options.seed));
+    
+    FuzzReport report = MoveGenFuzzer(options).run();
+    std::cerr << "Checked " << report.positions << " positions in " << report.games << " games in "
+              << report.timeSeconds << "s using " << options.threads << " threads: "
+              << report.positionsPerSecond() << " positions/s\n";
+    if (!report.failed) {
+        std::cerr << "No mismatches\n";
+        return 0;
+    }
+    
+    // loadFEN drops castling rights without king and rook at home, so such
+    // rights are flagged for whoever reproduces the failure
+    const char* forced = report.forcedCastling ? " (castling rights set with setGameState)" : "";
+    std::cout << "Mismatch: " << report.failure << "\n";
+    std::cout << "Position: " << report.fen << forced << "\n";
+    std::cout << "Moves:";
+    for (const auto& move : report.line) std::cout << " " << move;
+    std::cout << "\nMinimized: " << report.minimizedFen << forced << "\n";
+    return 1;
+}
+
+int runMatchMode(const std::vector<std::string>& args, const TablebaseConfig& tablebase,
+                 const PlacementConfig& placement) {
+    MatchOptions options;
+    options.tablebase = tablebase;
+    options.placement = placement;
+    if (args.size() < 3 || !EngineConfig::parse(args[1], options.first) ||
+        !EngineConfig::parse(args[2], options.second)) {
+        std::cerr << "Expected two engine specs such as depth=3 or movetime=100\n";
+        return 1;
+    }
+    
+    auto intOption = [&](const std::string& name, int fallback) {
+        return std::stoi(getOption(args, name, std::to_string(fallback)));
+    };
+    options.maxGames = std::max(2, intOption("--games", options.maxGames));
+    options.threads = std::max(1, intOption("--threads", options.threads));
+    options.bookPlies = std::max(0, intOption("--book-plies", options.bookPlies));
+    options.randomPlies = std::max(0, intOption("--random-plies", options.randomPlies));
+    options.maxPlies = std::max(1, intOption("--max-plies", options.maxPlies));
+    options.seed = static_cast<unsigned int>(intOption("--seed", options.seed));
+    options.sprt.elo0 = std::stod(getOption(args, "--elo0", std::to_string(options.sprt.elo0)));
+    options.sprt.elo1 = std::stod(getOption(args, "--elo1", std::to_string(options.sprt.elo1)));
+    options.sprt.alpha = std::stod(getOption(args, "--alpha", std::to_string(options.sprt.alpha)));
+    options.sprt.beta = std::stod(getOption(args, "--beta", std::to_string(options.sprt.beta)));
+    options.useSprt = std::find(args.begin(), args.end(), "--no-sprt") == args.end();
+    
+    MatchRunner runner(options);
+    std::string bookPath = getOption(args, "--book", "");
+    if (!bookPath.empty()) {
+        if (!runner.loadBook(bookPath)) {
+            std::cerr << "Cannot open " << bookPath << "\n";
+            return 1;
+        }
+        std::cerr << "Loaded " << runner.getBookSize() << " book lines\n";
+    }
+    
+    MatchStats stats = runner.run(std::cerr);
+    std::cout << "Final: ";
+    MatchRunner::report(stats, options, std::cout);
+    return 0;
+}
+
+int runMakeBookMode(const std::vector<std::string>& args) {
+    std::string outputPath = getOption(args, "--output", "");
+    if (outputPath.empty()) {
+        std::cerr << "--make-book needs --output <file.bin>\n";
+        return 1;
+    }
+    
+    BookBuilder builder(std::max(1, std::stoi(getOption(args, "--book-plies", "20"))));
+    PgnReplayer replayer([&](const PgnGame& game) {
+        if (game.error.empty()) builder.addGame(game.startPosition, game.moves, game.result);
+    });
+    
+    PgnReader reader(replayer);
+    std::string inputPath = getOption(args, "--make-book", "-");
+    if (inputPath == "-") {
+        reader.readStream(std::cin);
+    } else if (!reader.readFile(inputPath)) {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+    
+    if (!builder.write(outputPath)) {
+        std::cerr << "Cannot write " << outputPath << "\n";
+        return 1;
+    }
+    std::cerr << "Wrote " << builder.size() << " book positions from " << reader.getStats().games
+              << " games to " << outputPath << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    
+    // --book-keys may accompany any mode and is consumed here
+    auto keysOption = std::find(args.begin(), args.end(), "--book-keys");
+    if (keysOption != args.end()) {
+        if (keysOption + 1 == args.end() || !Zobrist::loadKeys(*(keysOption + 1))) {
+            std::cerr << "Cannot read 781 Polyglot keys\n";
+            return 1;
+        }
+        args.erase(keysOption, keysOption + 2);
+    }
+    
+    // Likewise the tablebase options
+    TablebaseConfig tablebase;
+    auto tbOption = std::find(args.begin(), args.end(), "--tb-path");
+    if (tbOption != args.end()) {
+        if (tbOption + 1 == args.end()) {
+            std::cerr << "--tb-path needs a directory\n";
+            return 1;
+        }
+        auto tables = std::make_shared<Tablebase>(*(tbOption + 1));
+        if (tables->available() == 0) {
+            std::cerr << "No Syzygy tablebases (.rtbw) found in " << *(tbOption + 1) << "\n";
+            return 1;
+        }
+        tablebase.tables = tables;
+        args.erase(tbOption, tbOption + 2);
+    }
+    auto probeDepthOption = std::find(args.begin(), args.end(), "--tb-probe-depth");
+    if (probeDepthOption != args.end() && probeDepthOption + 1 != args.end()) {
+        tablebase.probeDepth = std::max(0, std::stoi(*(probeDepthOption + 1)));
+        args.erase(probeDepthOption, probeDepthOption + 2);
+    }
+    
+    auto profileOption = std::find(args.begin(), args.end(), "--profile");
+    if (profileOption != args.end()) {
+        if (profileOption + 1 == args.end()) {
+            std::cerr << "--profile needs a file\n";
+            return 1;
+        }
+        if (!Instrumentation::ENABLED) std::cerr << "--profile: this build has no instrumentation (make instrument)\n";
+        Instrumentation::setOutput(*(profileOption + 1));
+        args.erase(profileOption, profileOption + 2);
+    }
+    
+    // Transposition table memory and worker placement, for every mode
+    PlacementConfig placement;
+    auto hashOption = std::find(args.begin(), args.end(), "--hash");
+    if (hashOption != args.end() && hashOption + 1 != args.end()) {
+        placement.hashMegabytes = std::max(1, std::stoi(*(hashOption + 1)));
+        args.erase(hashOption, hashOption + 2);
+    }
+    auto pagesOption = std::find(args.begin(), args.end(), "--pages");
+    if (pagesOption != args.end()) {
+        if (pagesOption + 1 == args.end() || !parsePageMode(*(pagesOption + 1), placement.pages)) {
+            std::cerr << "--pages needs small, transparent or explicit\n";
+            return 1;
+        }
+        args.erase(pagesOption, pagesOption + 2);
+    }
+    auto bindOption = std::find(args.begin(), args.end(), "--bind");
+    if (bindOption != args.end()) {
+        if (bindOption + 1 == args.end() || !parseThreadBinding(*(bindOption + 1), placement.binding)) {
+            std::cerr << "--bind needs none, cores or nodes\n";
+            return 1;
+        }
+        args.erase(bindOption, bindOption + 2);
+    }
+    
+    // Opening book and pondering for the AI players of the game menu
+    std::shared_ptr<OpeningBook> book;
+    auto polyglotOption = std::find(args.begin(), args.end(), "--polyglot");
+    if (polyglotOption != args.end()) {
+        if (polyglotOption + 1 == args.end()) {
+            std::cerr << "--polyglot needs a book file\n";
+            return 1;
+        }
+        book = std::make_shared<OpeningBook>();
+        if (!book->open(*(polyglotOption + 1))) {
+            std::cerr << "Cannot open opening book " << *(polyglotOption + 1) << "\n";
+            return 1;
+        }
+        std::cout << "Opening book: " << book->size() << " entries\n";
+        args.erase(polyglotOption, polyglotOption + 2);
+    }
+    BookSelection bookSelection = BookSelection::WEIGHTED;
+    auto bookBestOption = std::find(args.begin(), args.end(), "--book-best");
+    if (bookBestOption != args.end()) {
+        bookSelection = BookSelection::BEST;
+        args.erase(bookBestOption);
+    }
+    bool ponder = false;
+    auto ponderOption = std::find(args.begin(), args.end(), "--ponder");
+    if (ponderOption != args.end()) {
+        ponder = true;
+        args.erase(ponderOption);
+    }
+    
+    if (!args.empty()) {
+        try {
+            if (args[0] == "--batch") return runBatchMode(args, tablebase, placement);
+            if (args[0] == "--pgn") return runPgnMode(args);
+            if (args[0] == "--selfplay") return runSelfPlayMode(args, tablebase, placement);
+            if (args[0] == "--verify") return runVerifyMode(args);
+            if (args[0] == "--match") return runMatchMode(args, tablebase, placement);
+            if (args[0] == "--fuzz") return runFuzzMode(args);
+            if (args[0] == "--make-book") return runMakeBookMode(args);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        displayUsage();
+        return args[0] == "--help" ? 0 : 1;
+    }
+    
     int choice;
     
     while (true) {
@@ -43,7 +594,7 @@ int main() {
                 whitePlayer = std::make_unique<HumanPlayer>(Color::WHITE);
                 blackPlayer = std::make_unique<HumanPlayer>(Color::BLACK);
                 break;
-                
+            
             case 2: {
                 int difficulty = getAIDifficulty();
                 whitePlayer = std::make_unique<HumanPlayer>(Color::WHITE);
@@ -73,6 +624,16 @@ int main() {
                 continue;
         }
         
+        for (Player* player : {whitePlayer.get(), blackPlayer.get()}) {
+            AIPlayer* ai = dynamic_cast<AIPlayer*>(player);
+            if (!ai) continue;
+            if (book) ai->setBook(book, bookSelection);
+            ai->setTablebase(tablebase);
+            ai->setPonder(ponder);
+            ai->setHashSize(placement.hashMegabytes, placement.pages, static_cast<int>(Topology::allowedCpus().size()),
+                            placement.binding);
+        }
+        
         game.setPlayers(std::move(whitePlayer), std::move(blackPlayer));
         game.run();
     }
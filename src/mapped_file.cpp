@@ -0,0 +1,42 @@
+#include "mapped_file.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path, bool sequential) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) return false;
+    
+    if (sequential) {
+        madvise(address, info.st_size, MADV_SEQUENTIAL);
+    }
+    
+    mapping = static_cast<const char*>(address);
+    length = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping) {
+        munmap(const_cast<char*>(mapping), length);
+        mapping = nullptr;
+        length = 0;
+    }
+}
\ No newline at end of file
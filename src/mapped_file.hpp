@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Large inputs (PGN archives,
+// training data, books) are accessed through the page cache instead of being
+// copied into heap buffers.
+class MappedFile {
+private:
+    const char* mapping;
+    size_t length;
+    
+public:
+    MappedFile() : mapping(nullptr), length(0) {}
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool open(const std::string& path, bool sequential = false);
+    void close();
+    
+    bool isOpen() const { return mapping != nullptr; }
+    const char* data() const { return mapping; }
+    size_t size() const { return length; }
+};
\ No newline at end of file
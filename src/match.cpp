@@ -0,0 +1,258 @@
+#include "match.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+double eloFromScore(double score) {
+    // Clamp so that a perfect score reports a large but finite difference
+    score = std::max(0.001, std::min(0.999, score));
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+static double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+bool EngineConfig::parse(const std::string& spec, EngineConfig& config) {
+    config.name = spec;
+    config.limits = SearchLimits(0);
+    
+    std::istringstream stream(spec);
+    std::string item;
+    try {
+        while (std::getline(stream, item, ',')) {
+            size_t equals = item.find('=');
+            if (equals == std::string::npos) return false;
+            std::string key = item.substr(0, equals);
+            std::string value = item.substr(equals + 1);
+            
+            if (key == "depth") {
+                config.limits.depth = std::stoi(value);
+            } else if (key == "movetime") {
+                config.limits.moveTimeMs = std::stoi(value);
+            } else if (key == "nodes") {
+                config.limits.nodes = std::stoull(value);
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    
+    // Time- and node-limited searches deepen until the limit runs out
+    if (config.limits.depth <= 0) config.limits.depth = config.limits.isLimited() ? 64 : 3;
+    return true;
+}
+
+unsigned long long MatchStats::pairs() const {
+    unsigned long long total = 0;
+    for (unsigned long long count : pairScores) total += count;
+    return total;
+}
+
+double MatchStats::score() const {
+    return games() > 0 ? (wins + 0.5 * draws) / games() : 0.5;
+}
+
+// Mean and variance of the per-game score of a pair (0, 0.25, ..., 1), with
+// `prior` pseudo-pairs added to each of the 0.5- and 1.5-point bins
+static void pairMoments(const unsigned long long counts[5], double prior, double& total,
+                        double& mean, double& variance) {
+    double weights[5] = {static_cast<double>(counts[0]), counts[1] + prior, static_cast<double>(counts[2]),
+                         counts[3] + prior, static_cast<double>(counts[4])};
+    total = 0;
+    double sum = 0;
+    for (int i = 0; i < 5; i++) {
+        total += weights[i];
+        sum += weights[i] * 0.25 * i;
+    }
+    mean = total > 0 ? sum / total : 0.5;
+    
+    variance = 0;
+    for (int i = 0; i < 5; i++) {
+        variance += weights[i] * (0.25 * i - mean) * (0.25 * i - mean);
+    }
+    variance = total > 0 ? variance / total : 0;
+}
+
+double MatchStats::eloError() const {
+    double total, mean, variance;
+    pairMoments(pairScores, 0, total, mean, variance);
+    if (total < 2) return 0;
+    
+    double margin = 1.96 * std::sqrt(variance / total);
+    return (eloFromScore(mean + margin) - eloFromScore(mean - margin)) / 2;
+}
+
+// Generalized SPRT with a normal approximation of the pair scores. A prior of
+// two pairs (0.5 and 1.5 points) keeps the variance away from zero, so a few
+// lopsided early pairs, or deterministic engines whose pairs always split
+// evenly, cannot dominate the estimate.
+double MatchStats::llr(const SprtOptions& sprt) const {
+    if (pairs() == 0) return 0;
+    
+    double total, mean, variance;
+    pairMoments(pairScores, 1, total, mean, variance);
+    
+    double s0 = scoreFromElo(sprt.elo0), s1 = scoreFromElo(sprt.elo1);
+    return total * (s1 - s0) * (2 * mean - s0 - s1) / (2 * variance);
+}
+
+// Half-points scored by the engine that played `color`
+static int halfPointsFor(GameResult result, Color color) {
+    if (result == GameResult::DRAW || result == GameResult::ONGOING) return 1;
+    bool whiteWon = result == GameResult::WHITE_WINS;
+    return whiteWon == (color == Color::WHITE) ? 2 : 0;
+}
+
+bool MatchRunner::loadBook(const std::string& path) {
+    return openings.loadPgn(path, options.bookPlies);
+}
+
+GameResult MatchRunner::playGame(const Board& opening, AIPlayer& white, const SearchLimits& whiteLimits,
+                                 AIPlayer& black, const SearchLimits& blackLimits,
+                                 unsigned long long& nodes) const {
+    Board board, searchBoard;
+    unpackPosition(packPosition(opening), board);
+    white.clearHash();
+    black.clearHash();
+    int resignCount = 0, resignSign = 0;
+    
+    for (int ply = 0; ; ply++) {
+        GameResult result = resultByRule(board);
+        if (result != GameResult::ONGOING) return result;
+        if (options.tablebase.tables) {
+            result = resultByTablebase(*options.tablebase.tables, board);
+            if (result != GameResult::ONGOING) return result;
+        }
+        if (ply >= options.maxPlies) return GameResult::DRAW;
+        
+        // The searcher copies the board once; without the game's history that copy stays small
+        bool whiteToMove = board.getCurrentPlayer() == Color::WHITE;
+        unpackPosition(packPosition(board), searchBoard);
+        searchBoard.copyKeyHistory(board);
+        SearchResult searched = whiteToMove ? white.search(searchBoard, whiteLimits)
+                                            : black.search(searchBoard, blackLimits);
+        nodes += searched.nodes;
+        
+        int whiteScore = whiteToMove ? searched.score : -searched.score;
+        if (std::abs(whiteScore) >= options.resignScore) {
+            int sign = whiteScore > 0 ? 1 : -1;
+            resignCount = (sign == resignSign) ? resignCount + 1 : 1;
+            resignSign = sign;
+        } else {
+            resignCount = 0;
+            resignSign = 0;
+        }
+        if (resignCount >= options.resignPlies) {
+            return resignSign > 0 ? GameResult::WHITE_WINS : GameResult::BLACK_WINS;
+        }
+        
+        Move move = searched.bestMove;
+        board.makeMove(move);
+    }
+}
+
+MatchStats MatchRunner::run(std::ostream& log) {
+    const int numThreads = std::max(1, options.threads);
+    const unsigned long long maxPairs = static_cast<unsigned long long>(std::max(1, (options.maxGames + 1) / 2));
+    
+    std::atomic<unsigned long long> nextPair(0);
+    std::atomic<bool> finished(false);
+    std::mutex mutex;
+    MatchStats stats;
+    
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t]() {
+            Topology::bindThread(t, options.placement.binding);
+            AIPlayer firstEngine(Color::WHITE), secondEngine(Color::WHITE);
+            firstEngine.setHashSize(options.placement.hashMegabytes, options.placement.pages);
+            secondEngine.setHashSize(options.placement.hashMegabytes, options.placement.pages);
+            firstEngine.setTablebase(options.tablebase);
+            secondEngine.setTablebase(options.tablebase);
+            
+            while (!finished) {
+                unsigned long long pair = nextPair++;
+                if (pair >= maxPairs) return;
+                
+                std::seed_seq seed{options.seed, static_cast<unsigned int>(pair), static_cast<unsigned int>(pair >> 32)};
+                std::mt19937 rng(seed);
+                Board startPosition, opening;
+                std::vector<Move> moves;
+                bool generated = false;
+                for (int attempt = 0; attempt < 16 && !generated; attempt++) {
+                    moves.clear();
+                    generated = openings.generate(rng, options.randomPlies, startPosition, opening, moves);
+                }
+                if (!generated) continue;
+                
+                // Both engines play the same opening once with each color
+                unsigned long long nodes = 0;
+                GameResult firstWhite = playGame(opening, firstEngine, options.first.limits,
+                                                 secondEngine, options.second.limits, nodes);
+                GameResult firstBlack = playGame(opening, secondEngine, options.second.limits,
+                                                 firstEngine, options.first.limits, nodes);
+                
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stats.decision != SprtDecision::NONE) return;
+                
+                int firstPoints = 0;
+                for (int points : {halfPointsFor(firstWhite, Color::WHITE), halfPointsFor(firstBlack, Color::BLACK)}) {
+                    if (points == 2) stats.wins++;
+                    else if (points == 1) stats.draws++;
+                    else stats.losses++;
+                    firstPoints += points;
+                }
+                stats.pairScores[firstPoints]++;
+                stats.nodes += nodes;
+                
+                if (options.useSprt) {
+                    double llr = stats.llr(options.sprt);
+                    if (llr >= options.sprt.upperBound()) stats.decision = SprtDecision::ACCEPT_H1;
+                    else if (llr <= options.sprt.lowerBound()) stats.decision = SprtDecision::ACCEPT_H0;
+                    if (stats.decision != SprtDecision::NONE) finished = true;
+                }
+                if (options.reportInterval > 0 && stats.pairs() % options.reportInterval == 0) {
+                    stats.timeSeconds = elapsed();
+                    report(stats, options, log);
+                }
+            }
+        });
+    }
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    stats.timeSeconds = elapsed();
+    return stats;
+}
+
+void MatchRunner::report(const MatchStats& stats, const MatchOptions& options, std::ostream& out) {
+    out << std::fixed << std::setprecision(1)
+        << options.first.name << " vs " << options.second.name << ": " << stats.games() << " games, +"
+        << stats.wins << " =" << stats.draws << " -" << stats.losses
+        << ", score " << stats.score() * 100 << "%, Elo " << std::showpos << stats.elo() << std::noshowpos
+        << " +/- " << stats.eloError();
+    if (options.useSprt) {
+        out << std::setprecision(2) << ", LLR " << stats.llr(options.sprt) << " ["
+            << options.sprt.lowerBound() << ", " << options.sprt.upperBound() << "]";
+        if (stats.decision == SprtDecision::ACCEPT_H1) out << " H1 accepted";
+        if (stats.decision == SprtDecision::ACCEPT_H0) out << " H0 accepted";
+    }
+    out << " (" << std::setprecision(1) << stats.timeSeconds << "s)\n";
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+#include "board.hpp"
+#include "game.hpp"
+#include "player.hpp"
+#include "openings.hpp"
+#include "numa.hpp"
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// One side of a match: a label and the limits it searches with, parsed from
+// specs such as "depth=3" or "movetime=100,depth=20".
+struct EngineConfig {
+    std::string name;
+    SearchLimits limits;
+    
+    static bool parse(const std::string& spec, EngineConfig& config);
+};
+
+struct SprtOptions {
+    double elo0;
+    double elo1;
+    double alpha;
+    double beta;
+    
+    SprtOptions() : elo0(0), elo1(10), alpha(0.05), beta(0.05) {}
+    double lowerBound() const { return std::log(beta / (1 - alpha)); }
+    double upperBound() const { return std::log((1 - beta) / alpha); }
+};
+
+enum class SprtDecision { NONE, ACCEPT_H0, ACCEPT_H1 };
+
+struct MatchOptions {
+    EngineConfig first;
+    EngineConfig second;
+    int maxGames;
+    int threads;
+    int randomPlies;
+    int bookPlies;
+    int maxPlies;
+    int resignScore;
+    int resignPlies;
+    int reportInterval;         // pairs between progress lines, 0 = quiet
+    unsigned int seed;
+    bool useSprt;
+    SprtOptions sprt;
+    TablebaseConfig tablebase;  // used by both engines and for adjudication
+    PlacementConfig placement;
+    
+    MatchOptions() : maxGames(1000), threads(std::max(1u, std::thread::hardware_concurrency())),
+                     randomPlies(8), bookPlies(12), maxPlies(400), resignScore(1000), resignPlies(6),
+                     reportInterval(10), seed(1), useSprt(true) {}
+};
+
+double eloFromScore(double score);
+
+// Match score from the first engine's point of view. Games are played in
+// pairs from one opening with colors swapped; the pair scores (0 to 2 points)
+// form the pentanomial distribution the variance estimates are based on,
+// which accounts for the correlation within a pair.
+struct MatchStats {
+    unsigned long long wins;
+    unsigned long long draws;
+    unsigned long long losses;
+    unsigned long long pairScores[5];   // pairs scoring 0, 0.5, 1, 1.5, 2 points
+    unsigned long long nodes;
+    double timeSeconds;
+    SprtDecision decision;
+    
+    MatchStats() : wins(0), draws(0), losses(0), pairScores{0, 0, 0, 0, 0}, nodes(0),
+                   timeSeconds(0), decision(SprtDecision::NONE) {}
+    
+    unsigned long long games() const { return wins + draws + losses; }
+    unsigned long long pairs() const;
+    double score() const;
+    double elo() const { return eloFromScore(score()); }
+    double eloError() const;    // half-width of the 95% confidence interval
+    double llr(const SprtOptions& sprt) const;
+};
+
+// Plays two engine configurations against each other on a pool of worker
+// threads, stopping as soon as the SPRT accepts either hypothesis.
+class MatchRunner {
+private:
+    MatchOptions options;
+    OpeningSuite openings;
+    
+    GameResult playGame(const Board& opening, AIPlayer& white, const SearchLimits& whiteLimits,
+                        AIPlayer& black, const SearchLimits& blackLimits, unsigned long long& nodes) const;
+    
+public:
+    explicit MatchRunner(const MatchOptions& opts) : options(opts) {}
+    
+    bool loadBook(const std::string& path);
+    size_t getBookSize() const { return openings.size(); }
+    
+    MatchStats run(std::ostream& log);
+    
+    static void report(const MatchStats& stats, const MatchOptions& options, std::ostream& out);
+};
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 #include "pieces/piece.hpp"
-#include <memory>
+#include <cstdint>
 
 enum class MoveType { 
     NORMAL, 
@@ -15,27 +15,59 @@ struct Move {
     Position to;
     MoveType type;
     PieceType promotionPiece;
-    std::unique_ptr<Piece> capturedPiece;
     
     Move(Position f, Position t, MoveType mt = MoveType::NORMAL) 
         : from(f), to(t), type(mt), promotionPiece(PieceType::QUEEN) {}
+};
+
+// 16-bit move encoding: bits 0-5 origin square, bits 6-11 destination square
+// (square = row * 8 + col), bits 12-15 move kind.
+enum MoveCode : uint16_t {
+    CODE_NORMAL = 0,
+    CODE_CASTLE_KINGSIDE = 1,
+    CODE_CASTLE_QUEENSIDE = 2,
+    CODE_EN_PASSANT = 3,
+    CODE_PROMOTE_KNIGHT = 4,
+    CODE_PROMOTE_BISHOP = 5,
+    CODE_PROMOTE_ROOK = 6,
+    CODE_PROMOTE_QUEEN = 7
+};
+
+inline uint16_t packMove(const Move& move) {
+    uint16_t kind = CODE_NORMAL;
+    switch (move.type) {
+        case MoveType::CASTLE_KINGSIDE: kind = CODE_CASTLE_KINGSIDE; break;
+        case MoveType::CASTLE_QUEENSIDE: kind = CODE_CASTLE_QUEENSIDE; break;
+        case MoveType::EN_PASSANT: kind = CODE_EN_PASSANT; break;
+        case MoveType::PROMOTION:
+            switch (move.promotionPiece) {
+                case PieceType::KNIGHT: kind = CODE_PROMOTE_KNIGHT; break;
+                case PieceType::BISHOP: kind = CODE_PROMOTE_BISHOP; break;
+                case PieceType::ROOK: kind = CODE_PROMOTE_ROOK; break;
+                default: kind = CODE_PROMOTE_QUEEN; break;
+            }
+            break;
+        default: break;
+    }
+    return static_cast<uint16_t>((move.from.row * 8 + move.from.col) |
+                                 ((move.to.row * 8 + move.to.col) << 6) | (kind << 12));
+}
+
+inline Move unpackMove(uint16_t code) {
+    Position from((code & 63) / 8, (code & 63) % 8);
+    Position to(((code >> 6) & 63) / 8, ((code >> 6) & 63) % 8);
+    uint16_t kind = code >> 12;
     
-    Move(const Move& other) 
-        : from(other.from), to(other.to), type(other.type), 
-          promotionPiece(other.promotionPiece),
-          capturedPiece(other.capturedPiece ? other.capturedPiece->clone() : nullptr) {}
-    
-    Move& operator=(const Move& other) {
-        if (this != &other) {
-            from = other.from;
-            to = other.to;
-            type = other.type;
-            promotionPiece = other.promotionPiece;
-            capturedPiece = other.capturedPiece ? other.capturedPiece->clone() : nullptr;
+    switch (kind) {
+        case CODE_CASTLE_KINGSIDE: return Move(from, to, MoveType::CASTLE_KINGSIDE);
+        case CODE_CASTLE_QUEENSIDE: return Move(from, to, MoveType::CASTLE_QUEENSIDE);
+        case CODE_EN_PASSANT: return Move(from, to, MoveType::EN_PASSANT);
+        case CODE_NORMAL: return Move(from, to);
+        default: {
+            Move move(from, to, MoveType::PROMOTION);
+            PieceType promotions[4] = {PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN};
+            move.promotionPiece = promotions[(kind - CODE_PROMOTE_KNIGHT) & 3];
+            return move;
         }
-        return *this;
     }
-    
-    Move(Move&&) = default;
-    Move& operator=(Move&&) = default;
-}; 
\ No newline at end of file
+}
\ No newline at end of file
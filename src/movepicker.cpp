@@ -0,0 +1,115 @@
+#include "movepicker.hpp"
+
+// Attackers ranked from least to most valuable, indexed by PieceType
+static constexpr int ATTACKER_RANK[6] = {0, 3, 1, 2, 4, 5};
+
+MovePicker::MovePicker(const Board& position, uint16_t hashMove, bool captures, bool checks)
+    : board(position), side(position.getCurrentPlayer()), stage(Stage::FIRST_MOVE), firstMove(hashMove),
+      capturesOnly(captures), withChecks(checks), index(0) {}
+
+// A hash move may come from another position with the same key slot
+bool MovePicker::firstMovePlayable(Move& move) const {
+    if (!board.isPseudoLegal(firstMove)) return false;
+    move = unpackMove(firstMove);
+    return true;
+}
+
+void MovePicker::scoreMoves() {
+    scores.resize(moves.size());
+    for (size_t i = 0; i < moves.size(); i++) {
+        const Move& move = moves[i];
+        const Piece* victim = board.getPiece(move.to);
+        int score = 0;
+        if (victim || move.type == MoveType::EN_PASSANT) {
+            int victimValue = victim ? victim->getValue() : pieceValue(PieceType::PAWN);
+            score = victimValue * 8 - ATTACKER_RANK[static_cast<int>(board.getPiece(move.from)->getType())];
+        }
+        if (move.type == MoveType::PROMOTION) score += pieceValue(move.promotionPiece);
+        scores[i] = score;
+    }
+}
+
+// Selection sort, one step per call: most nodes only look at a few moves
+bool MovePicker::pickBest(Move& move) {
+    while (index < moves.size()) {
+        size_t best = index;
+        for (size_t i = index + 1; i < moves.size(); i++) {
+            if (scores[i] > scores[best]) best = i;
+        }
+        std::swap(moves[index], moves[best]);
+        std::swap(scores[index], scores[best]);
+        
+        const Move& candidate = moves[index++];
+        if (packMove(candidate) != firstMove) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MovePicker::pickInOrder(Move& move) {
+    while (index < moves.size()) {
+        const Move& candidate = moves[index++];
+        if (packMove(candidate) != firstMove) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MovePicker::next(Move& move) {
+    while (true) {
+        switch (stage) {
+            case Stage::FIRST_MOVE:
+                stage = board.isInCheck(side) ? Stage::GENERATE_EVASIONS : Stage::GENERATE_CAPTURES;
+                if (firstMove) {
+                    if (firstMovePlayable(move)) return true;
+                    firstMove = 0;
+                }
+                break;
+            
+            case Stage::GENERATE_CAPTURES:
+                board.generateCaptures(side, moves);
+                scoreMoves();
+                stage = Stage::CAPTURES;
+                break;
+            
+            case Stage::CAPTURES:
+                if (pickBest(move)) return true;
+                if (!capturesOnly) stage = Stage::GENERATE_QUIETS;
+                else stage = withChecks ? Stage::GENERATE_QUIET_CHECKS : Stage::DONE;
+                break;
+            
+            case Stage::GENERATE_QUIETS:
+            case Stage::GENERATE_QUIET_CHECKS:
+                moves.clear();
+                index = 0;
+                if (stage == Stage::GENERATE_QUIETS) board.generateQuiets(side, moves);
+                else board.generateQuietChecks(side, moves);
+                stage = stage == Stage::GENERATE_QUIETS ? Stage::QUIETS : Stage::QUIET_CHECKS;
+                break;
+            
+            case Stage::QUIETS:
+            case Stage::QUIET_CHECKS:
+                if (pickInOrder(move)) return true;
+                stage = Stage::DONE;
+                break;
+            
+            case Stage::GENERATE_EVASIONS:
+                board.generateEvasions(side, moves);
+                scoreMoves();
+                stage = Stage::EVASIONS;
+                break;
+            
+            case Stage::EVASIONS:
+                if (pickBest(move)) return true;
+                stage = Stage::DONE;
+                break;
+            
+            case Stage::DONE:
+                return false;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include "board.hpp"
+#include "move.hpp"
+#include <cstdint>
+#include <vector>
+
+// Hands out the pseudo-legal moves of a position one at a time, generating
+// them in stages so that a node which cuts off early never generates the
+// rest: the hash move, then captures and promotions best first (most
+// valuable victim, least valuable attacker), then quiet moves. A side in
+// check gets its evasions instead. The caller tests each move for legality.
+class MovePicker {
+private:
+    enum class Stage {
+        FIRST_MOVE,
+        GENERATE_CAPTURES, CAPTURES,
+        GENERATE_QUIETS, QUIETS,
+        GENERATE_QUIET_CHECKS, QUIET_CHECKS,
+        GENERATE_EVASIONS, EVASIONS,
+        DONE
+    };
+    
+    const Board& board;
+    Color side;
+    Stage stage;
+    uint16_t firstMove;                 // packed, 0 once it is known to be unplayable
+    bool capturesOnly;
+    bool withChecks;
+    MoveList moves;
+    std::vector<int, ArenaAllocator<int>> scores;
+    size_t index;
+    
+    bool firstMovePlayable(Move& move) const;
+    void scoreMoves();
+    bool pickBest(Move& move);
+    bool pickInOrder(Move& move);
+    
+    MovePicker(const Board& position, uint16_t hashMove, bool captures, bool checks);
+    
+public:
+    // Every move, for the main search. `hashMove` (packed, 0 for none) comes
+    // first when it is a move of this position.
+    MovePicker(const Board& position, uint16_t hashMove) : MovePicker(position, hashMove, false, false) {}
+    
+    // Captures and promotions for the quiescence search, followed by the
+    // quiet moves that give check if `checks` is set
+    static MovePicker quiescence(const Board& position, bool checks) { return MovePicker(position, 0, true, checks); }
+    
+    // False once every move has been handed out
+    bool next(Move& move);
+};
\ No newline at end of file
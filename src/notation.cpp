@@ -0,0 +1,305 @@
+#include "notation.hpp"
+
+Position parsePosition(const std::string& posStr) {
+    if (posStr.length() != 2) return Position(-1, -1);
+    
+    char file = posStr[0];
+    char rank = posStr[1];
+    
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') {
+        return Position(-1, -1);
+    }
+    
+    return Position(8 - (rank - '0'), file - 'a');
+}
+
+std::string positionToString(const Position& pos) {
+    if (pos.row < 0 || pos.row >= 8 || pos.col < 0 || pos.col >= 8) {
+        return "";
+    }
+    
+    char file = 'a' + pos.col;
+    char rank = '8' - pos.row;
+    
+    return std::string(1, file) + std::string(1, rank);
+}
+
+bool parseMove(const std::string& moveStr, Move& move) {
+    if (moveStr.length() < 4 || moveStr.length() > 5) return false;
+    
+    Position from = parsePosition(moveStr.substr(0, 2));
+    Position to = parsePosition(moveStr.substr(2, 2));
+    
+    if (from.row == -1 || to.row == -1) return false;
+    
+    move = Move(from, to);
+    
+    if (moveStr.length() == 5) {
+        char promotion = moveStr[4];
+        switch (promotion) {
+            case 'q': case 'Q': move.promotionPiece = PieceType::QUEEN; break;
+            case 'r': case 'R': move.promotionPiece = PieceType::ROOK; break;
+            case 'b': case 'B': move.promotionPiece = PieceType::BISHOP; break;
+            case 'n': case 'N': move.promotionPiece = PieceType::KNIGHT; break;
+            default: return false;
+        }
+        move.type = MoveType::PROMOTION;
+    }
+    
+    return true;
+}
+
+std::string moveToString(const Move& move) {
+    std::string result = positionToString(move.from) + positionToString(move.to);
+    
+    if (move.type == MoveType::PROMOTION) {
+        switch (move.promotionPiece) {
+            case PieceType::QUEEN: result += 'q'; break;
+            case PieceType::ROOK: result += 'r'; break;
+            case PieceType::BISHOP: result += 'b'; break;
+            case PieceType::KNIGHT: result += 'n'; break;
+            default: result += 'q'; break;
+        }
+    }
+    
+    return result;
+}
+
+static char pieceLetter(PieceType type) {
+    switch (type) {
+        case PieceType::KNIGHT: return 'N';
+        case PieceType::BISHOP: return 'B';
+        case PieceType::ROOK: return 'R';
+        case PieceType::QUEEN: return 'Q';
+        case PieceType::KING: return 'K';
+        default: return 0;
+    }
+}
+
+static bool letterToPiece(char letter, PieceType& type) {
+    switch (letter) {
+        case 'N': type = PieceType::KNIGHT; return true;
+        case 'B': type = PieceType::BISHOP; return true;
+        case 'R': type = PieceType::ROOK; return true;
+        case 'Q': type = PieceType::QUEEN; return true;
+        case 'K': type = PieceType::KING; return true;
+        default: return false;
+    }
+}
+
+// Collects the squares holding a `type` piece of `color` that can move to `to`,
+// by looking backwards from the destination rather than generating moves.
+// Returns the number of origins written (at most 16).
+static int findOrigins(const Board& board, PieceType type, Color color, Position to, Position* origins) {
+    int count = 0;
+    const Piece* target = board.getPiece(to);
+    if (target && target->getColor() == color) return 0;
+    
+    auto collect = [&](int row, int col) {
+        if (row < 0 || row >= 8 || col < 0 || col >= 8) return;
+        const Piece* piece = board.getPiece(Position(row, col));
+        if (piece && piece->getColor() == color && piece->getType() == type) {
+            origins[count++] = Position(row, col);
+        }
+    };
+    
+    switch (type) {
+        case PieceType::PAWN: {
+            int direction = (color == Color::WHITE) ? -1 : 1;
+            int startRow = (color == Color::WHITE) ? 6 : 1;
+            if (target || board.getGameState().enPassantTarget == to) {
+                collect(to.row - direction, to.col - 1);
+                collect(to.row - direction, to.col + 1);
+            } else {
+                collect(to.row - direction, to.col);
+                if (count == 0 && to.row - 2 * direction == startRow &&
+                    !board.getPiece(Position(to.row - direction, to.col))) {
+                    collect(to.row - 2 * direction, to.col);
+                }
+            }
+            break;
+        }
+        case PieceType::KNIGHT: {
+            int knightMoves[8][2] = {
+                {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+                {1, -2}, {1, 2}, {2, -1}, {2, 1}
+            };
+            for (int i = 0; i < 8; i++) collect(to.row + knightMoves[i][0], to.col + knightMoves[i][1]);
+            break;
+        }
+        case PieceType::KING: {
+            for (int dr = -1; dr <= 1; dr++) {
+                for (int dc = -1; dc <= 1; dc++) {
+                    if (dr != 0 || dc != 0) collect(to.row + dr, to.col + dc);
+                }
+            }
+            break;
+        }
+        default: {
+            int directions[8][2] = {
+                {-1, 0}, {1, 0}, {0, -1}, {0, 1},
+                {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
+            };
+            int first = (type == PieceType::BISHOP) ? 4 : 0;
+            int last = (type == PieceType::ROOK) ? 4 : 8;
+            for (int d = first; d < last; d++) {
+                int row = to.row + directions[d][0];
+                int col = to.col + directions[d][1];
+                while (row >= 0 && row < 8 && col >= 0 && col < 8) {
+                    if (board.getPiece(Position(row, col))) {
+                        collect(row, col);
+                        break;
+                    }
+                    row += directions[d][0];
+                    col += directions[d][1];
+                }
+            }
+            break;
+        }
+    }
+    
+    return count;
+}
+
+static Move makeCandidate(const Board& board, Position from, Position to) {
+    const Piece* piece = board.getPiece(from);
+    if (piece->getType() == PieceType::PAWN) {
+        if (to.row == 0 || to.row == 7) return Move(from, to, MoveType::PROMOTION);
+        if (!board.getPiece(to) && from.col != to.col) return Move(from, to, MoveType::EN_PASSANT);
+    }
+    return Move(from, to);
+}
+
+static bool findCastle(const Board& board, MoveType castle, Move& move) {
+    Color color = board.getCurrentPlayer();
+    int row = (color == Color::WHITE) ? 7 : 0;
+    const Piece* king = board.getPiece(Position(row, 4));
+    if (!king || king->getType() != PieceType::KING || king->getColor() != color) return false;
+    
+    // Castling is rare enough that the king's own generator does the checks
+    MoveList candidates;
+    king->generateMoves(board, Position(row, 4), candidates);
+    for (const auto& candidate : candidates) {
+        if (candidate.type == castle) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseSAN(const Board& board, std::string_view san, Move& move) {
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.remove_suffix(1);
+    }
+    if (san.size() < 2) return false;
+    
+    if (san == "O-O" || san == "0-0") return findCastle(board, MoveType::CASTLE_KINGSIDE, move);
+    if (san == "O-O-O" || san == "0-0-0") return findCastle(board, MoveType::CASTLE_QUEENSIDE, move);
+    
+    PieceType pieceType = PieceType::PAWN;
+    if (letterToPiece(san.front(), pieceType)) {
+        san.remove_prefix(1);
+    }
+    
+    bool isPromotion = false;
+    PieceType promotion = PieceType::QUEEN;
+    if (san.size() >= 2 && letterToPiece(san.back(), promotion)) {
+        isPromotion = true;
+        san.remove_suffix(1);
+        if (san.back() == '=') san.remove_suffix(1);
+    }
+    if (san.size() < 2) return false;
+    
+    char file = san[san.size() - 2], rank = san[san.size() - 1];
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') return false;
+    Position to(8 - (rank - '0'), file - 'a');
+    san.remove_suffix(2);
+    
+    int fromRow = -1, fromCol = -1;
+    for (char c : san) {
+        if (c >= 'a' && c <= 'h') fromCol = c - 'a';
+        else if (c >= '1' && c <= '8') fromRow = 8 - (c - '0');
+        else if (c != 'x' && c != ':' && c != '-') return false;
+    }
+    
+    Position origins[16];
+    int count = findOrigins(board, pieceType, board.getCurrentPlayer(), to, origins);
+    int matches = 0;
+    
+    for (int i = 0; i < count; i++) {
+        if (fromCol != -1 && origins[i].col != fromCol) continue;
+        if (fromRow != -1 && origins[i].row != fromRow) continue;
+        
+        Move candidate = makeCandidate(board, origins[i], to);
+        if ((candidate.type == MoveType::PROMOTION) != isPromotion) continue;
+        if (board.leavesKingInCheck(candidate)) continue;
+        
+        candidate.promotionPiece = promotion;
+        move = candidate;
+        matches++;
+    }
+    
+    return matches == 1;
+}
+
+std::string moveToSAN(const Board& board, const Move& move) {
+    // Longest SAN is 7 characters ("Qh4xe1+"), so the result always fits the
+    // small-string buffer and the common path never touches the heap.
+    char san[8];
+    int length = 0;
+    
+    const Piece* piece = board.getPiece(move.from);
+    if (!piece) return std::string();
+    
+    if (move.type == MoveType::CASTLE_KINGSIDE || move.type == MoveType::CASTLE_QUEENSIDE) {
+        san[length++] = 'O';
+        san[length++] = '-';
+        san[length++] = 'O';
+        if (move.type == MoveType::CASTLE_QUEENSIDE) {
+            san[length++] = '-';
+            san[length++] = 'O';
+        }
+    } else {
+        bool isCapture = board.getPiece(move.to) != nullptr || move.type == MoveType::EN_PASSANT;
+        
+        if (piece->getType() == PieceType::PAWN) {
+            if (isCapture) san[length++] = static_cast<char>('a' + move.from.col);
+        } else {
+            san[length++] = pieceLetter(piece->getType());
+            
+            Position origins[16];
+            int count = findOrigins(board, piece->getType(), piece->getColor(), move.to, origins);
+            bool ambiguous = false, sameCol = false, sameRow = false;
+            for (int i = 0; i < count; i++) {
+                if (origins[i] == move.from) continue;
+                if (board.leavesKingInCheck(Move(origins[i], move.to))) continue;
+                ambiguous = true;
+                if (origins[i].col == move.from.col) sameCol = true;
+                if (origins[i].row == move.from.row) sameRow = true;
+            }
+            if (ambiguous) {
+                if (!sameCol || sameRow) san[length++] = static_cast<char>('a' + move.from.col);
+                if (sameCol) san[length++] = static_cast<char>('8' - move.from.row);
+            }
+        }
+        
+        if (isCapture) san[length++] = 'x';
+        san[length++] = static_cast<char>('a' + move.to.col);
+        san[length++] = static_cast<char>('8' - move.to.row);
+        
+        if (move.type == MoveType::PROMOTION) {
+            san[length++] = '=';
+            san[length++] = pieceLetter(move.promotionPiece);
+        }
+    }
+    
+    if (board.givesCheck(move)) {
+        // Only checking moves pay for a board copy to look for a reply
+        Board after = board;
+        after.makeMove(move);
+        san[length++] = after.hasLegalMoves(after.getCurrentPlayer()) ? '+' : '#';
+    }
+    
+    return std::string(san, length);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+#include "board.hpp"
+#include "move.hpp"
+#include <string>
+#include <string_view>
+
+Position parsePosition(const std::string& posStr);
+std::string positionToString(const Position& pos);
+bool parseMove(const std::string& moveStr, Move& move);
+std::string moveToString(const Move& move);
+
+// Standard Algebraic Notation (Nf3, exd5, O-O, e8=Q+) relative to `board`,
+// which must be the position before the move is played.
+bool parseSAN(const Board& board, std::string_view san, Move& move);
+std::string moveToSAN(const Board& board, const Move& move);
\ No newline at end of file
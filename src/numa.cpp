@@ -0,0 +1,242 @@
+#include "numa.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const size_t HUGE_PAGE_BYTES = 2 << 20;
+
+static size_t roundUp(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+const char* pageModeName(PageMode mode) {
+    switch (mode) {
+        case PageMode::SMALL: return "small";
+        case PageMode::TRANSPARENT: return "transparent";
+        case PageMode::EXPLICIT: return "explicit";
+        default: return "?";
+    }
+}
+
+const char* threadBindingName(ThreadBinding binding) {
+    switch (binding) {
+        case ThreadBinding::NONE: return "none";
+        case ThreadBinding::CORES: return "cores";
+        case ThreadBinding::NODES: return "nodes";
+        default: return "?";
+    }
+}
+
+bool parsePageMode(const std::string& text, PageMode& mode) {
+    for (PageMode candidate : {PageMode::SMALL, PageMode::TRANSPARENT, PageMode::EXPLICIT}) {
+        if (text == pageModeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseThreadBinding(const std::string& text, ThreadBinding& binding) {
+    for (ThreadBinding candidate : {ThreadBinding::NONE, ThreadBinding::CORES, ThreadBinding::NODES}) {
+        if (text == threadBindingName(candidate)) {
+            binding = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parses a kernel CPU or node list such as "0-3,8-11"
+static std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range[0] < '0' || range[0] > '9') continue;
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int value = first; value <= last; value++) values.push_back(value);
+    }
+    return values;
+}
+
+static std::string readLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+std::string Topology::describe() {
+    size_t nodeCount = nodes().size(), cpuCount = allowedCpus().size();
+    std::ostringstream out;
+    out << nodeCount << (nodeCount == 1 ? " NUMA node, " : " NUMA nodes, ") << cpuCount
+        << (cpuCount == 1 ? " CPU" : " CPUs");
+    return out.str();
+}
+
+#ifdef __linux__
+
+bool LargePageBuffer::allocate(size_t bytes, PageMode mode) {
+    release();
+    if (bytes == 0) return false;
+    
+    if (mode == PageMode::EXPLICIT) {
+        size_t rounded = roundUp(bytes, HUGE_PAGE_BYTES);
+        void* mapped = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapped != MAP_FAILED) {
+            memory = mapped;
+            mappedBytes = rounded;
+            backing = PageMode::EXPLICIT;
+            return true;
+        }
+        mode = PageMode::TRANSPARENT;
+    }
+    
+    // Below one huge page there is nothing to gain
+    if (bytes < HUGE_PAGE_BYTES) mode = PageMode::SMALL;
+    size_t rounded = roundUp(bytes, mode == PageMode::SMALL ? static_cast<size_t>(sysconf(_SC_PAGESIZE))
+                                                            : HUGE_PAGE_BYTES);
+    
+    // Map one huge page more and trim both ends, so that the table starts on
+    // a huge page boundary and every page of it can be a huge one
+    size_t padded = rounded + HUGE_PAGE_BYTES;
+    void* mapped = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) return false;
+    uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+    uintptr_t aligned = roundUp(start, HUGE_PAGE_BYTES);
+    if (aligned > start) munmap(mapped, aligned - start);
+    if (start + padded > aligned + rounded) munmap(reinterpret_cast<void*>(aligned + rounded),
+                                                   start + padded - aligned - rounded);
+    memory = reinterpret_cast<void*>(aligned);
+    mappedBytes = rounded;
+    
+    backing = PageMode::SMALL;
+    if (mode == PageMode::TRANSPARENT && madvise(memory, mappedBytes, MADV_HUGEPAGE) == 0) {
+        backing = PageMode::TRANSPARENT;
+    } else {
+        madvise(memory, mappedBytes, MADV_NOHUGEPAGE);
+    }
+    return true;
+}
+
+void LargePageBuffer::release() {
+    if (memory) munmap(memory, mappedBytes);
+    memory = nullptr;
+    mappedBytes = 0;
+    backing = PageMode::SMALL;
+}
+
+size_t LargePageBuffer::hugePageBytes() const {
+    if (!memory) return 0;
+    uintptr_t first = reinterpret_cast<uintptr_t>(memory), last = first + mappedBytes;
+    
+    // Sums the huge page fields of every mapping overlapping the buffer
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool inside = false;
+    size_t kilobytes = 0;
+    while (std::getline(smaps, line)) {
+        unsigned long long start, end;
+        char dash;
+        std::istringstream fields(line);
+        if (line.find(':') > line.find(' ') && fields >> std::hex >> start >> dash >> end && dash == '-') {
+            inside = start < last && end > first;
+            continue;
+        }
+        if (!inside) continue;
+        if (line.compare(0, 14, "AnonHugePages:") == 0 || line.compare(0, 16, "Private_Hugetlb:") == 0) {
+            kilobytes += std::strtoull(line.c_str() + line.find(':') + 1, nullptr, 10);
+        }
+    }
+    return kilobytes * 1024;
+}
+
+std::vector<int> Topology::allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    
+    // The process's mask, from the main thread, which is never bound
+    if (sched_getaffinity(getpid(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) cpus.push_back(0);
+    return cpus;
+}
+
+std::vector<std::vector<int>> Topology::nodes() {
+    std::vector<int> allowed = allowedCpus();
+    std::vector<std::vector<int>> result;
+    for (int node : parseList(readLine("/sys/devices/system/node/online"))) {
+        std::vector<int> cpus;
+        for (int cpu : parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))) {
+            for (int candidate : allowed) {
+                if (candidate == cpu) cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) result.push_back(cpus);
+    }
+    if (result.empty()) result.push_back(allowed);
+    return result;
+}
+
+bool Topology::bindThread(int index, ThreadBinding binding) {
+    if (binding == ThreadBinding::NONE) return true;
+    
+    std::vector<int> cpus;
+    if (binding == ThreadBinding::CORES) {
+        std::vector<int> allowed = allowedCpus();
+        cpus.push_back(allowed[index % allowed.size()]);
+    } else {
+        std::vector<std::vector<int>> all = nodes();
+        cpus = all[index % all.size()];
+    }
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+#else
+
+bool LargePageBuffer::allocate(size_t bytes, PageMode) {
+    release();
+    if (bytes == 0) return false;
+    mappedBytes = roundUp(bytes, HUGE_PAGE_BYTES);
+    memory = ::operator new(mappedBytes, std::align_val_t(HUGE_PAGE_BYTES), std::nothrow);
+    if (!memory) {
+        mappedBytes = 0;
+        return false;
+    }
+    std::memset(memory, 0, mappedBytes);
+    return true;
+}
+
+void LargePageBuffer::release() {
+    if (memory) ::operator delete(memory, std::align_val_t(HUGE_PAGE_BYTES));
+    memory = nullptr;
+    mappedBytes = 0;
+}
+
+size_t LargePageBuffer::hugePageBytes() const { return 0; }
+
+std::vector<int> Topology::allowedCpus() { return {0}; }
+std::vector<std::vector<int>> Topology::nodes() { return {allowedCpus()}; }
+bool Topology::bindThread(int index, ThreadBinding binding) { return index >= 0 && binding == ThreadBinding::NONE; }
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class PageMode {
+    SMALL,                      // base pages only (MADV_NOHUGEPAGE)
+    TRANSPARENT,                // transparent huge pages, madvise(MADV_HUGEPAGE)
+    EXPLICIT                    // the reserved hugetlb pool (MAP_HUGETLB), else TRANSPARENT
+};
+
+enum class ThreadBinding {
+    NONE,
+    CORES,                      // worker i runs on the i-th allowed CPU, round robin
+    NODES                       // worker i runs on the CPUs of NUMA node i, round robin
+};
+
+const char* pageModeName(PageMode mode);
+const char* threadBindingName(ThreadBinding binding);
+bool parsePageMode(const std::string& text, PageMode& mode);
+bool parseThreadBinding(const std::string& text, ThreadBinding& binding);
+
+// How the worker threads of a mode are placed and their transposition tables
+// backed. A worker binds itself before it allocates its table, so the table's
+// pages are first touched, and therefore placed, on the worker's own node.
+struct PlacementConfig {
+    size_t hashMegabytes;       // per searcher
+    PageMode pages;
+    ThreadBinding binding;
+    
+    PlacementConfig() : hashMegabytes(4), pages(PageMode::TRANSPARENT), binding(ThreadBinding::NONE) {}
+};
+
+// Anonymous zeroed memory for one large table, aligned to the huge page size
+// and backed as requested where the system allows: madvise is refused when
+// transparent huge pages are disabled, and MAP_HUGETLB when no huge pages are
+// reserved (vm.nr_hugepages). No page is touched here; the kernel places each
+// one on the NUMA node of the thread that first writes it.
+class LargePageBuffer {
+private:
+    void* memory;
+    size_t mappedBytes;
+    PageMode backing;
+    
+public:
+    LargePageBuffer() : memory(nullptr), mappedBytes(0), backing(PageMode::SMALL) {}
+    ~LargePageBuffer() { release(); }
+    
+    LargePageBuffer(const LargePageBuffer&) = delete;
+    LargePageBuffer& operator=(const LargePageBuffer&) = delete;
+    
+    // False if no memory could be mapped at all
+    bool allocate(size_t bytes, PageMode mode);
+    void release();
+    
+    void* data() const { return memory; }
+    size_t size() const { return mappedBytes; }
+    
+    // What the mapping got, after any fallback
+    PageMode getBacking() const { return backing; }
+    
+    // Bytes of the mapping currently in huge pages, from /proc/self/smaps;
+    // transparent huge pages only appear once touched
+    size_t hugePageBytes() const;
+};
+
+// CPUs and NUMA nodes this process may run on, from sched_getaffinity and
+// /sys/devices/system/node, without libnuma. Elsewhere there is a single
+// node and binding does nothing.
+class Topology {
+public:
+    static std::vector<int> allowedCpus();
+    
+    // Allowed CPUs of each node that has any; a single entry without NUMA
+    static std::vector<std::vector<int>> nodes();
+    
+    // Pins the calling thread as worker `index`; false if the binding failed
+    // or is not supported
+    static bool bindThread(int index, ThreadBinding binding);
+    
+    // "2 NUMA nodes, 64 CPUs"
+    static std::string describe();
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "openings.hpp"
+#include "pgn.hpp"
+#include <algorithm>
+
+bool OpeningSuite::loadPgn(const std::string& path, int plies) {
+    PgnReplayer replayer([&](const PgnGame& game) {
+        if (!game.error.empty() || game.moves.empty()) return;
+        size_t count = std::min(game.moves.size(), static_cast<size_t>(std::max(0, plies)));
+        lines.push_back({packPosition(game.startPosition),
+                         std::vector<Move>(game.moves.begin(), game.moves.begin() + count)});
+    });
+    
+    PgnReader reader(replayer);
+    return reader.readFile(path);
+}
+
+bool OpeningSuite::generate(std::mt19937& rng, int randomPlies, Board& start, Board& board,
+                            std::vector<Move>& moves) const {
+    const BookLine* line = lines.empty() ? nullptr : &lines[rng() % lines.size()];
+    if (line) {
+        unpackPosition(line->start, board);
+    } else {
+        board.clear();
+        board.setupInitialPosition();
+    }
+    start = board;
+    
+    if (line) {
+        for (const auto& bookMove : line->moves) {
+            Move move = bookMove;
+            board.makeMove(move);
+            moves.push_back(bookMove);
+        }
+    }
+    for (int ply = 0; ply < randomPlies; ply++) {
+        std::vector<Move> legalMoves = board.getLegalMoves(board.getCurrentPlayer());
+        if (legalMoves.empty()) return false;
+        
+        Move move = legalMoves[rng() % legalMoves.size()];
+        board.makeMove(move);
+        moves.push_back(std::move(move));
+    }
+    return board.hasLegalMoves(board.getCurrentPlayer());
+}
\ No newline at end of file
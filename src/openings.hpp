@@ -0,0 +1,29 @@
+#pragma once
+#include "board.hpp"
+#include "binary_format.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+// Start positions for engine-vs-engine games: a random line from a PGN book
+// (if one is loaded) followed by a number of uniformly random plies.
+class OpeningSuite {
+private:
+    struct BookLine {
+        PackedPosition start;
+        std::vector<Move> moves;
+    };
+    
+    std::vector<BookLine> lines;
+    
+public:
+    // Keeps the first `plies` plies of every game in the PGN file.
+    bool loadPgn(const std::string& path, int plies);
+    size_t size() const { return lines.size(); }
+    
+    // Sets `start` to the line's start position and `board` to the position
+    // after the opening, whose moves are appended to `moves`. Returns false
+    // when the opening leaves the side to move without a legal move.
+    bool generate(std::mt19937& rng, int randomPlies, Board& start, Board& board,
+                  std::vector<Move>& moves) const;
+};
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* PerfCounters::name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::CYCLES: return "cycles";
+        case PerfEvent::INSTRUCTIONS: return "instructions";
+        case PerfEvent::CACHE_MISSES: return "cache-misses";
+        case PerfEvent::BRANCH_MISSES: return "branch-misses";
+        case PerfEvent::DTLB_MISSES: return "dTLB-misses";
+        case PerfEvent::TASK_CLOCK: return "task-clock-ns";
+        case PerfEvent::PAGE_FAULTS: return "page-faults";
+        default: return "?";
+    }
+}
+
+std::string PerfSample::format(double units, const std::string& unit) const {
+    std::ostringstream out;
+    out << std::fixed;
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (!valid[i]) continue;
+        double value = units > 0 ? values[i] / units : 0;
+        out << (out.tellp() > 0 ? "  " : "") << PerfCounters::name(static_cast<PerfEvent>(i)) << " "
+            << std::setprecision(value < 10 ? 3 : 1) << value << "/" << unit;
+    }
+    if (has(PerfEvent::CYCLES) && has(PerfEvent::INSTRUCTIONS) && get(PerfEvent::CYCLES) > 0) {
+        out << "  IPC " << std::setprecision(2)
+            << static_cast<double>(get(PerfEvent::INSTRUCTIONS)) / get(PerfEvent::CYCLES);
+    }
+    return out.str();
+}
+
+PerfCounters::PerfCounters() : baseline{} {
+    fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+bool PerfCounters::isOpen() const {
+    for (int fd : fds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+bool PerfCounters::hasHardware() const {
+    return fds[static_cast<int>(PerfEvent::CYCLES)] >= 0 || fds[static_cast<int>(PerfEvent::INSTRUCTIONS)] >= 0;
+}
+
+#ifdef __linux__
+
+bool PerfCounters::open() {
+    close();
+    error.clear();
+    
+    struct EventConfig {
+        uint32_t type;
+        uint64_t config;
+    };
+    const EventConfig configs[PERF_EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    };
+    
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = configs[i].type;
+        attr.config = configs[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        
+        // This process on any CPU; unprivileged users need
+        // kernel.perf_event_paranoid <= 2
+        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[i] < 0 && error.empty()) {
+            error = std::string(name(static_cast<PerfEvent>(i))) + ": " + std::strerror(errno);
+        }
+    }
+    return isOpen();
+}
+
+void PerfCounters::close() {
+    for (int& fd : fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+}
+
+void PerfCounters::start() {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] < 0) continue;
+        if (read(fds[i], baseline[i].data(), sizeof(baseline[i])) != static_cast<ssize_t>(sizeof(baseline[i]))) {
+            baseline[i].fill(0);
+        }
+        ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] < 0) continue;
+        ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        
+        // value, time enabled, time running, since start()
+        uint64_t data[3];
+        if (read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+        for (int k = 0; k < 3; k++) data[k] -= std::min(data[k], baseline[i][k]);
+        if (data[2] == 0) continue;
+        sample.values[i] = data[2] < data[1] ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+                                             : data[0];
+        sample.valid[i] = true;
+    }
+    return sample;
+}
+
+#else
+
+bool PerfCounters::open() {
+    error = "perf_event_open is only available on Linux";
+    return false;
+}
+
+void PerfCounters::close() {}
+void PerfCounters::start() {}
+PerfSample PerfCounters::stop() { return PerfSample(); }
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+enum class PerfEvent {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,               // last-level cache
+    BRANCH_MISSES,
+    DTLB_MISSES,                // data TLB read misses
+    TASK_CLOCK,                 // nanoseconds on the CPU, a software event
+    PAGE_FAULTS,                // software event
+    COUNT
+};
+
+constexpr int PERF_EVENT_COUNT = static_cast<int>(PerfEvent::COUNT);
+
+// Counts of one measured phase. Counters the kernel multiplexed are scaled
+// up to the whole phase.
+struct PerfSample {
+    std::array<uint64_t, PERF_EVENT_COUNT> values;
+    std::array<bool, PERF_EVENT_COUNT> valid;
+    
+    PerfSample() : values{}, valid{} {}
+    bool has(PerfEvent event) const { return valid[static_cast<int>(event)]; }
+    uint64_t get(PerfEvent event) const { return values[static_cast<int>(event)]; }
+    
+    // Sums the phases of a measurement taken in parts
+    PerfSample& operator+=(const PerfSample& other) {
+        for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+            values[i] += other.values[i];
+            valid[i] = valid[i] || other.valid[i];
+        }
+        return *this;
+    }
+    
+    // "cycles 812.4/node  IPC 2.31  ..." for the available counters, each
+    // divided by `units`; empty if none was counted
+    std::string format(double units, const std::string& unit) const;
+};
+
+// Hardware performance counters of this process (and the threads it starts
+// while they are open) through Linux perf_event_open. Every event is opened
+// on its own, so a machine without, say, a TLB miss event still reports the
+// others; without a PMU at all (most VMs) only the software events remain,
+// and elsewhere nothing is counted and stop() returns an empty sample.
+class PerfCounters {
+private:
+    std::array<int, PERF_EVENT_COUNT> fds;
+    std::string error;
+    
+    // Readings at start(): value, time enabled, time running. A reset does
+    // not clear what exited threads added, so phases are differences.
+    std::array<std::array<uint64_t, 3>, PERF_EVENT_COUNT> baseline;
+    
+public:
+    PerfCounters();
+    ~PerfCounters();
+    
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    
+    // Opens every counter it can; false if none could be opened
+    bool open();
+    void close();
+    bool isOpen() const;
+    bool hasHardware() const;
+    
+    // Why counters are missing, e.g. the errno of the first failed open
+    const std::string& getError() const { return error; }
+    
+    void start();
+    PerfSample stop();
+    
+    static const char* name(PerfEvent event);
+};
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "pgn.hpp"
+#include "mapped_file.hpp"
+#include "notation.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+static bool isResultToken(std::string_view token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+static bool isDelimiter(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+           c == '{' || c == '}' || c == '(' || c == ')' || c == ';' || c == '[';
+}
+
+size_t PgnReader::parseBuffer(const char* data, size_t size) {
+    const char* p = data;
+    const char* end = data + size;
+    bool inGame = false, inMovetext = false;
+    size_t games = 0;
+    
+    auto finishGame = [&](std::string_view result) {
+        visitor.endGame(result);
+        inGame = false;
+        inMovetext = false;
+        games++;
+    };
+    
+    while (p < end) {
+        char c = *p;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            p++;
+            continue;
+        }
+        
+        if (c == '%' && (p == data || p[-1] == '\n')) {
+            while (p < end && *p != '\n') p++;
+            continue;
+        }
+        
+        if (c == '[') {
+            if (inMovetext) finishGame("*");
+            if (!inGame) {
+                visitor.beginGame();
+                inGame = true;
+            }
+            
+            p++;
+            while (p < end && (*p == ' ' || *p == '\t')) p++;
+            const char* nameStart = p;
+            while (p < end && *p != ' ' && *p != '\t' && *p != '"' && *p != ']') p++;
+            std::string_view name(nameStart, p - nameStart);
+            
+            while (p < end && *p != '"' && *p != ']' && *p != '\n') p++;
+            std::string_view value;
+            if (p < end && *p == '"') {
+                const char* valueStart = ++p;
+                while (p < end && *p != '"' && *p != '\n') {
+                    if (*p == '\\' && p + 1 < end) p++;
+                    p++;
+                }
+                value = std::string_view(valueStart, p - valueStart);
+            }
+            while (p < end && *p != ']' && *p != '\n') p++;
+            if (p < end && *p == ']') p++;
+            
+            visitor.tag(name, value);
+            continue;
+        }
+        
+        if (!inGame) {
+            visitor.beginGame();
+            inGame = true;
+        }
+        inMovetext = true;
+        
+        if (c == '{') {
+            const char* close = static_cast<const char*>(memchr(p, '}', end - p));
+            p = close ? close + 1 : end;
+            continue;
+        }
+        if (c == ';') {
+            const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+            p = newline ? newline + 1 : end;
+            continue;
+        }
+        if (c == '(') {
+            int depth = 0;
+            while (p < end) {
+                if (*p == '(') {
+                    depth++;
+                } else if (*p == ')') {
+                    if (--depth == 0) {
+                        p++;
+                        break;
+                    }
+                } else if (*p == '{') {
+                    const char* close = static_cast<const char*>(memchr(p, '}', end - p));
+                    if (!close) {
+                        p = end;
+                        break;
+                    }
+                    p = close;
+                }
+                p++;
+            }
+            continue;
+        }
+        if (c == ')' || c == '}') {
+            p++;
+            continue;
+        }
+        
+        const char* tokenStart = p;
+        while (p < end && !isDelimiter(*p)) p++;
+        std::string_view token(tokenStart, p - tokenStart);
+        
+        if (token[0] == '$') continue;
+        if (isResultToken(token)) {
+            finishGame(token);
+            continue;
+        }
+        
+        // Move numbers may be glued to the move ("12.e4", "12...e5")
+        size_t skip = 0;
+        while (skip < token.size() && token[skip] >= '0' && token[skip] <= '9') skip++;
+        if (skip > 0) {
+            if (skip == token.size() || token[skip] != '.') continue;
+            while (skip < token.size() && token[skip] == '.') skip++;
+            token.remove_prefix(skip);
+        }
+        while (!token.empty() && (token.back() == '!' || token.back() == '?')) token.remove_suffix(1);
+        
+        if (!token.empty()) visitor.move(token);
+    }
+    
+    if (inGame) finishGame("*");
+    return games;
+}
+
+void PgnReader::readBuffer(const char* data, size_t size) {
+    auto start = std::chrono::steady_clock::now();
+    stats.games += parseBuffer(data, size);
+    stats.bytes += size;
+    stats.timeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool PgnReader::readFile(const std::string& path) {
+    MappedFile file;
+    if (file.open(path, true)) {
+        readBuffer(file.data(), file.size());
+        return true;
+    }
+    
+    std::ifstream input(path, std::ios::binary);
+    if (!input) return false;
+    readStream(input);
+    return true;
+}
+
+void PgnReader::readStream(std::istream& input) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<char> buffer;
+    size_t filled = 0;
+    
+    while (true) {
+        if (buffer.size() < filled + CHUNK_SIZE) buffer.resize(filled + CHUNK_SIZE);
+        input.read(buffer.data() + filled, CHUNK_SIZE);
+        size_t got = static_cast<size_t>(input.gcount());
+        filled += got;
+        bool final = got == 0 || !input;
+        
+        // Only hand complete games to the parser: cut before the tag section
+        // of the last game in the buffer and carry that tail into the next
+        // chunk. A game larger than a chunk simply grows the buffer.
+        size_t cut = filled;
+        if (!final) {
+            cut = 0;
+            for (size_t i = filled; i-- > 1;) {
+                if (buffer[i] == '[' && buffer[i - 1] == '\n') {
+                    size_t lineStart = i;
+                    while (lineStart > 1) {
+                        size_t prev = lineStart - 1;
+                        size_t prevStart = prev;
+                        while (prevStart > 0 && buffer[prevStart - 1] != '\n') prevStart--;
+                        if (buffer[prevStart] != '[') break;
+                        lineStart = prevStart;
+                    }
+                    cut = lineStart;
+                    break;
+                }
+            }
+        }
+        
+        if (cut > 0) {
+            stats.games += parseBuffer(buffer.data(), cut);
+            stats.bytes += cut;
+            filled -= cut;
+            memmove(buffer.data(), buffer.data() + cut, filled);
+        }
+        if (final) break;
+    }
+    
+    stats.timeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PgnReplayer::beginGame() {
+    game.tags.clear();
+    game.moves.clear();
+    game.result.clear();
+    game.error.clear();
+    board.clear();
+    board.setupInitialPosition();
+    game.startPosition = board;
+}
+
+void PgnReplayer::tag(std::string_view name, std::string_view value) {
+    std::string unescaped;
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '\\' && i + 1 < value.size()) i++;
+        unescaped += value[i];
+    }
+    
+    if (name == "FEN") {
+        if (board.loadFEN(unescaped)) {
+            game.startPosition = board;
+        } else {
+            game.error = "invalid FEN tag";
+        }
+    }
+    game.tags.emplace_back(std::string(name), std::move(unescaped));
+}
+
+void PgnReplayer::move(std::string_view san) {
+    if (!game.error.empty()) return;
+    
+    Move move(Position(-1, -1), Position(-1, -1));
+    if (!parseSAN(board, san, move)) {
+        game.error = "illegal move " + std::string(san) + " at ply " + std::to_string(game.moves.size() + 1);
+        return;
+    }
+    board.makeMove(move);
+    game.moves.push_back(std::move(move));
+}
+
+void PgnReplayer::endGame(std::string_view result) {
+    game.result = std::string(result);
+    if (!game.error.empty()) errors++;
+    if (onGame) onGame(game);
+}
+
+static std::string escapeTagValue(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void PgnWriter::writeGame(const PgnGame& game) {
+    writeGame(game.tags, game.startPosition, game.moves, game.result);
+}
+
+void PgnWriter::writeGame(const std::vector<std::pair<std::string, std::string>>& tags,
+                          const Board& startPosition, const std::vector<Move>& moves,
+                          const std::string& result) {
+    std::string resultToken = isResultToken(result) ? result : "*";
+    
+    bool hasResult = false;
+    for (const auto& tag : tags) {
+        const std::string& value = (tag.first == "Result") ? resultToken : tag.second;
+        hasResult |= tag.first == "Result";
+        out << '[' << tag.first << " \"" << escapeTagValue(value) << "\"]\n";
+    }
+    if (!hasResult) out << "[Result \"" << resultToken << "\"]\n";
+    out << '\n';
+    
+    Board board = startPosition;
+    std::string line;
+    int moveNumber = board.getGameState().fullmoveNumber;
+    bool first = true;
+    
+    auto append = [&](const std::string& token) {
+        if (!line.empty() && line.size() + 1 + token.size() > 79) {
+            out << line << '\n';
+            line.clear();
+        }
+        if (!line.empty()) line += ' ';
+        line += token;
+    };
+    
+    for (const auto& move : moves) {
+        bool white = board.getCurrentPlayer() == Color::WHITE;
+        if (white) {
+            append(std::to_string(moveNumber) + ". " + moveToSAN(board, move));
+        } else if (first) {
+            append(std::to_string(moveNumber) + "... " + moveToSAN(board, move));
+        } else {
+            append(moveToSAN(board, move));
+        }
+        first = false;
+        
+        board.makeMove(move);
+        if (!white) moveNumber++;
+    }
+    append(resultToken);
+    out << line << "\n\n";
+}
\ No newline at end of file
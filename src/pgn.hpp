@@ -0,0 +1,96 @@
+#pragma once
+#include "board.hpp"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Receives the tokens of a PGN stream. All string_views point into the
+// reader's buffer and are only valid for the duration of the callback.
+class PgnVisitor {
+public:
+    virtual ~PgnVisitor() = default;
+    
+    virtual void beginGame() {}
+    virtual void tag(std::string_view, std::string_view) {}
+    virtual void move(std::string_view) {}
+    virtual void endGame(std::string_view) {}
+};
+
+struct PgnStats {
+    unsigned long long bytes;
+    unsigned long long games;
+    double timeSeconds;
+    
+    PgnStats() : bytes(0), games(0), timeSeconds(0) {}
+    double megabytesPerSecond() const { return timeSeconds > 0 ? bytes / 1e6 / timeSeconds : 0; }
+    double gamesPerSecond() const { return timeSeconds > 0 ? games / timeSeconds : 0; }
+};
+
+// Streaming PGN tokenizer. Files are memory-mapped when possible; other
+// inputs are read in fixed-size chunks that are cut at game boundaries.
+// Comments, variations and NAGs are skipped; tags and SAN moves are
+// delivered as views into the input without per-token allocation.
+class PgnReader {
+private:
+    PgnVisitor& visitor;
+    PgnStats stats;
+    
+    size_t parseBuffer(const char* data, size_t size);
+    
+public:
+    static constexpr size_t CHUNK_SIZE = 4 << 20;
+    
+    explicit PgnReader(PgnVisitor& v) : visitor(v) {}
+    
+    bool readFile(const std::string& path);
+    void readStream(std::istream& input);
+    void readBuffer(const char* data, size_t size);
+    
+    const PgnStats& getStats() const { return stats; }
+};
+
+struct PgnGame {
+    std::vector<std::pair<std::string, std::string>> tags;
+    Board startPosition;
+    std::vector<Move> moves;
+    std::string result;
+    std::string error;
+};
+
+// Replays every game on a Board as it is read and hands the finished game
+// to a callback. Games with an unparsable or illegal move are reported with
+// `error` set and the moves replayed up to that point.
+class PgnReplayer : public PgnVisitor {
+private:
+    std::function<void(const PgnGame&)> onGame;
+    PgnGame game;
+    Board board;
+    unsigned long long errors;
+    
+public:
+    explicit PgnReplayer(std::function<void(const PgnGame&)> callback)
+        : onGame(std::move(callback)), errors(0) {}
+    
+    void beginGame() override;
+    void tag(std::string_view name, std::string_view value) override;
+    void move(std::string_view san) override;
+    void endGame(std::string_view result) override;
+    
+    unsigned long long getErrorCount() const { return errors; }
+};
+
+class PgnWriter {
+private:
+    std::ostream& out;
+    
+public:
+    explicit PgnWriter(std::ostream& output) : out(output) {}
+    
+    void writeGame(const PgnGame& game);
+    void writeGame(const std::vector<std::pair<std::string, std::string>>& tags,
+                   const Board& startPosition, const std::vector<Move>& moves,
+                   const std::string& result);
+};
\ No newline at end of file
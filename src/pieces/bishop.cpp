@@ -1,9 +1,7 @@
 #include "bishop.hpp"
 #include "../board.hpp"
 
-std::vector<Move> Bishop::getLegalMoves(const Board& board, Position pos) const {
-    std::vector<Move> moves;
-    
+void Bishop::generateMoves(const Board& board, Position pos, MoveList& moves) const {
     int directions[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
     
     for (int d = 0; d < 4; d++) {
@@ -17,7 +15,7 @@ std::vector<Move> Bishop::getLegalMoves(const Board& board, Position pos) const
                 break;
             }
             
-            Piece* target = board.getPiece(newPos);
+            const Piece* target = board.getPiece(newPos);
             if (target == nullptr) {
                 moves.emplace_back(pos, newPos);
             } else {
@@ -28,6 +26,4 @@ std::vector<Move> Bishop::getLegalMoves(const Board& board, Position pos) const
             }
         }
     }
-    
-    return moves;
-} 
\ No newline at end of file
+}
\ No newline at end of file
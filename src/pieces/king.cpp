@@ -1,9 +1,7 @@
 #include "king.hpp"
 #include "../board.hpp"
 
-std::vector<Move> King::getLegalMoves(const Board& board, Position pos) const {
-    std::vector<Move> moves;
-    
+void King::generateMoves(const Board& board, Position pos, MoveList& moves) const {
     int directions[8][2] = {
         {-1, -1}, {-1, 0}, {-1, 1},
         {0, -1},           {0, 1},
@@ -14,7 +12,7 @@ std::vector<Move> King::getLegalMoves(const Board& board, Position pos) const {
         Position newPos(pos.row + directions[i][0], pos.col + directions[i][1]);
         
         if (newPos.row >= 0 && newPos.row < 8 && newPos.col >= 0 && newPos.col < 8) {
-            Piece* target = board.getPiece(newPos);
+            const Piece* target = board.getPiece(newPos);
             if (target == nullptr || target->getColor() != color) {
                 moves.emplace_back(pos, newPos);
             }
@@ -24,43 +22,24 @@ std::vector<Move> King::getLegalMoves(const Board& board, Position pos) const {
     const GameState& state = board.getGameState();
     Color oppositeColor = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
     
-    if (!board.isInCheck(color)) {
-        if (isWhite()) {
-            if (state.whiteCanCastleKingside && 
-                board.getPiece(Position(7, 5)) == nullptr &&
-                board.getPiece(Position(7, 6)) == nullptr &&
-                !board.isSquareAttacked(Position(7, 5), oppositeColor) &&
-                !board.isSquareAttacked(Position(7, 6), oppositeColor)) {
-                moves.emplace_back(pos, Position(7, 6), MoveType::CASTLE_KINGSIDE);
-            }
-            
-            if (state.whiteCanCastleQueenside &&
-                board.getPiece(Position(7, 1)) == nullptr &&
-                board.getPiece(Position(7, 2)) == nullptr &&
-                board.getPiece(Position(7, 3)) == nullptr &&
-                !board.isSquareAttacked(Position(7, 2), oppositeColor) &&
-                !board.isSquareAttacked(Position(7, 3), oppositeColor)) {
-                moves.emplace_back(pos, Position(7, 2), MoveType::CASTLE_QUEENSIDE);
-            }
-        } else {
-            if (state.blackCanCastleKingside &&
-                board.getPiece(Position(0, 5)) == nullptr &&
-                board.getPiece(Position(0, 6)) == nullptr &&
-                !board.isSquareAttacked(Position(0, 5), oppositeColor) &&
-                !board.isSquareAttacked(Position(0, 6), oppositeColor)) {
-                moves.emplace_back(pos, Position(0, 6), MoveType::CASTLE_KINGSIDE);
-            }
-            
-            if (state.blackCanCastleQueenside &&
-                board.getPiece(Position(0, 1)) == nullptr &&
-                board.getPiece(Position(0, 2)) == nullptr &&
-                board.getPiece(Position(0, 3)) == nullptr &&
-                !board.isSquareAttacked(Position(0, 2), oppositeColor) &&
-                !board.isSquareAttacked(Position(0, 3), oppositeColor)) {
-                moves.emplace_back(pos, Position(0, 2), MoveType::CASTLE_QUEENSIDE);
-            }
+    // Castling needs the king and the rook still on their home squares
+    int homeRow = isWhite() ? 7 : 0;
+    bool canKingside = isWhite() ? state.whiteCanCastleKingside : state.blackCanCastleKingside;
+    bool canQueenside = isWhite() ? state.whiteCanCastleQueenside : state.blackCanCastleQueenside;
+    auto rookAt = [&](int col) {
+        const Piece* rook = board.getPiece(Position(homeRow, col));
+        return rook && rook->getType() == PieceType::ROOK && rook->getColor() == color;
+    };
+    auto empty = [&](int col) { return board.getPiece(Position(homeRow, col)) == nullptr; };
+    auto safe = [&](int col) { return !board.isSquareAttacked(Position(homeRow, col), oppositeColor); };
+    
+    if (pos == Position(homeRow, 4) && !board.isInCheck(color)) {
+        if (canKingside && rookAt(7) && empty(5) && empty(6) && safe(5) && safe(6)) {
+            moves.emplace_back(pos, Position(homeRow, 6), MoveType::CASTLE_KINGSIDE);
+        }
+        
+        if (canQueenside && rookAt(0) && empty(1) && empty(2) && empty(3) && safe(2) && safe(3)) {
+            moves.emplace_back(pos, Position(homeRow, 2), MoveType::CASTLE_QUEENSIDE);
         }
     }
-    
-    return moves;
-} 
\ No newline at end of file
+}
\ No newline at end of file
@@ -3,12 +3,7 @@
 
 class King : public Piece {
 public:
-    King(Color c) : Piece(c, PieceType::KING) {}
+    constexpr King(Color c) : Piece(c, PieceType::KING) {}
     
-    std::vector<Move> getLegalMoves(const Board& board, Position pos) const override;
-    char getSymbol() const override { return isWhite() ? 'K' : 'k'; }
-    int getValue() const override { return 20000; }
-    std::unique_ptr<Piece> clone() const override {
-        return std::make_unique<King>(color);
-    }
+    void generateMoves(const Board& board, Position pos, MoveList& moves) const override;
 }; 
\ No newline at end of file
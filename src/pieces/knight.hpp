@@ -3,12 +3,7 @@
 
 class Knight : public Piece {
 public:
-    Knight(Color c) : Piece(c, PieceType::KNIGHT) {}
+    constexpr Knight(Color c) : Piece(c, PieceType::KNIGHT) {}
     
-    std::vector<Move> getLegalMoves(const Board& board, Position pos) const override;
-    char getSymbol() const override { return isWhite() ? 'N' : 'n'; }
-    int getValue() const override { return 320; }
-    std::unique_ptr<Piece> clone() const override {
-        return std::make_unique<Knight>(color);
-    }
+    void generateMoves(const Board& board, Position pos, MoveList& moves) const override;
 }; 
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+#include "../board.hpp"
+
+// Move generators dispatched at compile time: one instantiation per piece
+// type and color, so that the direction loops unroll and nothing goes
+// through the Piece vtable. They produce the same moves in the same order as
+// the virtual Piece::generateMoves implementations, which remain the
+// reference.
+
+constexpr int KNIGHT_STEPS[8][2] = {
+    {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+    {1, -2}, {1, 2}, {2, -1}, {2, 1}
+};
+constexpr int KING_STEPS[8][2] = {
+    {-1, -1}, {-1, 0}, {-1, 1},
+    {0, -1},           {0, 1},
+    {1, -1},  {1, 0},  {1, 1}
+};
+
+// Which moves a generator emits. CAPTURES are the captures, en passant and
+// every promotion; QUIETS are the remaining moves, castling included.
+enum class GenType { ALL, CAPTURES, QUIETS };
+
+template <Color Side>
+struct SideTraits {
+    static constexpr Color opponent = Side == Color::WHITE ? Color::BLACK : Color::WHITE;
+    static constexpr int forward = Side == Color::WHITE ? -1 : 1;
+    static constexpr int homeRow = Side == Color::WHITE ? 7 : 0;
+    static constexpr int pawnStartRow = Side == Color::WHITE ? 6 : 1;
+    static constexpr int promotionRow = Side == Color::WHITE ? 0 : 7;
+};
+
+template <Color Side, GenType Gen>
+inline void addStep(const Board& board, Position from, int row, int col, MoveList& moves) {
+    if (row < 0 || row >= 8 || col < 0 || col >= 8) return;
+    uint8_t target = board.getPieceCode(row, col);
+    if (target == NO_PIECE ? Gen != GenType::CAPTURES : Gen != GenType::QUIETS && codeColor(target) != Side) {
+        moves.emplace_back(from, Position(row, col));
+    }
+}
+
+template <Color Side, GenType Gen, int DeltaRow, int DeltaCol>
+inline void addSlides(const Board& board, Position from, MoveList& moves) {
+    int row = from.row + DeltaRow, col = from.col + DeltaCol;
+    while (row >= 0 && row < 8 && col >= 0 && col < 8) {
+        uint8_t target = board.getPieceCode(row, col);
+        if (target != NO_PIECE) {
+            if (Gen != GenType::QUIETS && codeColor(target) != Side) moves.emplace_back(from, Position(row, col));
+            return;
+        }
+        if (Gen != GenType::CAPTURES) moves.emplace_back(from, Position(row, col));
+        row += DeltaRow;
+        col += DeltaCol;
+    }
+}
+
+inline void addPromotions(Position from, Position to, MoveList& moves) {
+    for (PieceType piece : {PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT}) {
+        moves.emplace_back(from, to, MoveType::PROMOTION);
+        moves.back().promotionPiece = piece;
+    }
+}
+
+template <PieceType Type, Color Side>
+struct MoveGenerator;
+
+template <Color Side>
+struct MoveGenerator<PieceType::PAWN, Side> {
+    template <GenType Gen = GenType::ALL>
+    static void generate(const Board& board, Position from, MoveList& moves) {
+        using Traits = SideTraits<Side>;
+        Position oneStep(from.row + Traits::forward, from.col);
+        if (!board.getPiece(oneStep)) {
+            if (oneStep.row == Traits::promotionRow) {
+                if (Gen != GenType::QUIETS) addPromotions(from, oneStep, moves);
+            } else if (Gen != GenType::CAPTURES) {
+                moves.emplace_back(from, oneStep);
+                
+                Position twoStep(from.row + 2 * Traits::forward, from.col);
+                if (from.row == Traits::pawnStartRow && !board.getPiece(twoStep)) {
+                    moves.emplace_back(from, twoStep);
+                }
+            }
+        }
+        if (Gen == GenType::QUIETS) return;
+        
+        const Position& enPassant = board.getGameState().enPassantTarget;
+        for (int colOffset : {-1, 1}) {
+            Position capture(from.row + Traits::forward, from.col + colOffset);
+            if (capture.col < 0 || capture.col >= 8) continue;
+            
+            const Piece* target = board.getPiece(capture);
+            if (target && target->getColor() != Side) {
+                if (capture.row == Traits::promotionRow) {
+                    addPromotions(from, capture, moves);
+                } else {
+                    moves.emplace_back(from, capture);
+                }
+            }
+            if (enPassant == capture) moves.emplace_back(from, capture, MoveType::EN_PASSANT);
+        }
+    }
+};
+
+template <Color Side>
+struct MoveGenerator<PieceType::KNIGHT, Side> {
+    template <GenType Gen = GenType::ALL>
+    static void generate(const Board& board, Position from, MoveList& moves) {
+        for (const auto& step : KNIGHT_STEPS) {
+            addStep<Side, Gen>(board, from, from.row + step[0], from.col + step[1], moves);
+        }
+    }
+};
+
+template <Color Side>
+struct MoveGenerator<PieceType::BISHOP, Side> {
+    template <GenType Gen = GenType::ALL>
+    static void generate(const Board& board, Position from, MoveList& moves) {
+        addSlides<Side, Gen, -1, -1>(board, from, moves);
+        addSlides<Side, Gen, -1, 1>(board, from, moves);
+        addSlides<Side, Gen, 1, -1>(board, from, moves);
+        addSlides<Side, Gen, 1, 1>(board, from, moves);
+    }
+};
+
+template <Color Side>
+struct MoveGenerator<PieceType::ROOK, Side> {
+    template <GenType Gen = GenType::ALL>
+    static void generate(const Board& board, Position from, MoveList& moves) {
+        addSlides<Side, Gen, -1, 0>(board, from, moves);
+        addSlides<Side, Gen, 1, 0>(board, from, moves);
+        addSlides<Side, Gen, 0, -1>(board, from, moves);
+        addSlides<Side, Gen, 0, 1>(board, from, moves);
+    }
+};
+
+template <Color Side>
+struct MoveGenerator<PieceType::QUEEN, Side> {
+    template <GenType Gen = GenType::ALL>
+    static void generate(const Board& board, Position from, MoveList& moves) {
+        addSlides<Side, Gen, -1, -1>(board, from, moves);
+        addSlides<Side, Gen, -1, 0>(board, from, moves);
+        addSlides<Side, Gen, -1, 1>(board, from, moves);
+        addSlides<Side, Gen, 0, -1>(board, from, moves);
+        addSlides<Side, Gen, 0, 1>(board, from, moves);
+        addSlides<Side, Gen, 1, -1>(board, from, moves);
+        addSlides<Side, Gen, 1, 0>(board, from, moves);
+        addSlides<Side, Gen, 1, 1>(board, from, moves);
+    }
+};
+
+template <Color Side>
+struct MoveGenerator<PieceType::KING, Side> {
+    template <GenType Gen = GenType::ALL>
+    static void generate(const Board& board, Position from, MoveList& moves) {
+        using Traits = SideTraits<Side>;
+        for (const auto& step : KING_STEPS) {
+            addStep<Side, Gen>(board, from, from.row + step[0], from.col + step[1], moves);
+        }
+        if (Gen == GenType::CAPTURES) return;
+        
+        const GameState& state = board.getGameState();
+        bool kingside = Side == Color::WHITE ? state.whiteCanCastleKingside : state.blackCanCastleKingside;
+        bool queenside = Side == Color::WHITE ? state.whiteCanCastleQueenside : state.blackCanCastleQueenside;
+        constexpr int row = Traits::homeRow;
+        
+        // Rights are only trusted with the king and the rook still at home
+        constexpr uint8_t rook = pieceCode(PieceType::ROOK, Side);
+        kingside = kingside && board.getPieceCode(row, 7) == rook;
+        queenside = queenside && board.getPieceCode(row, 0) == rook;
+        if ((!kingside && !queenside) || !(from == Position(row, 4)) || board.isInCheck(Side)) return;
+        
+        if (kingside && !board.getPiece(Position(row, 5)) && !board.getPiece(Position(row, 6)) &&
+            !board.isSquareAttacked(Position(row, 5), Traits::opponent) &&
+            !board.isSquareAttacked(Position(row, 6), Traits::opponent)) {
+            moves.emplace_back(from, Position(row, 6), MoveType::CASTLE_KINGSIDE);
+        }
+        if (queenside && !board.getPiece(Position(row, 1)) && !board.getPiece(Position(row, 2)) &&
+            !board.getPiece(Position(row, 3)) &&
+            !board.isSquareAttacked(Position(row, 2), Traits::opponent) &&
+            !board.isSquareAttacked(Position(row, 3), Traits::opponent)) {
+            moves.emplace_back(from, Position(row, 2), MoveType::CASTLE_QUEENSIDE);
+        }
+    }
+};
+
+// Moves of a `type` piece of color Side standing on `from`
+template <Color Side, GenType Gen = GenType::ALL>
+inline void generatePieceMoves(const Board& board, PieceType type, Position from, MoveList& moves) {
+    switch (type) {
+        case PieceType::PAWN: MoveGenerator<PieceType::PAWN, Side>::template generate<Gen>(board, from, moves); break;
+        case PieceType::KNIGHT: MoveGenerator<PieceType::KNIGHT, Side>::template generate<Gen>(board, from, moves); break;
+        case PieceType::BISHOP: MoveGenerator<PieceType::BISHOP, Side>::template generate<Gen>(board, from, moves); break;
+        case PieceType::ROOK: MoveGenerator<PieceType::ROOK, Side>::template generate<Gen>(board, from, moves); break;
+        case PieceType::QUEEN: MoveGenerator<PieceType::QUEEN, Side>::template generate<Gen>(board, from, moves); break;
+        case PieceType::KING: MoveGenerator<PieceType::KING, Side>::template generate<Gen>(board, from, moves); break;
+    }
+}
\ No newline at end of file
@@ -1,8 +1,15 @@
 #include "pawn.hpp"
 #include "../board.hpp"
 
-std::vector<Move> Pawn::getLegalMoves(const Board& board, Position pos) const {
-    std::vector<Move> moves;
+// One move per promotion piece, queen first
+static void addPromotions(MoveList& moves, Position from, Position to) {
+    for (PieceType piece : {PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT}) {
+        moves.emplace_back(from, to, MoveType::PROMOTION);
+        moves.back().promotionPiece = piece;
+    }
+}
+
+void Pawn::generateMoves(const Board& board, Position pos, MoveList& moves) const {
     int direction = isWhite() ? -1 : 1;
     int startRow = isWhite() ? 6 : 1;
     int promotionRow = isWhite() ? 0 : 7;
@@ -10,7 +17,7 @@ std::vector<Move> Pawn::getLegalMoves(const Board& board, Position pos) const {
     Position oneStep(pos.row + direction, pos.col);
     if (board.getPiece(oneStep) == nullptr) {
         if (oneStep.row == promotionRow) {
-            moves.emplace_back(pos, oneStep, MoveType::PROMOTION);
+            addPromotions(moves, pos, oneStep);
         } else {
             moves.emplace_back(pos, oneStep);
         }
@@ -26,10 +33,10 @@ std::vector<Move> Pawn::getLegalMoves(const Board& board, Position pos) const {
     for (int colOffset : {-1, 1}) {
         Position capturePos(pos.row + direction, pos.col + colOffset);
         if (capturePos.col >= 0 && capturePos.col < 8) {
-            Piece* target = board.getPiece(capturePos);
+            const Piece* target = board.getPiece(capturePos);
             if (target && target->getColor() != color) {
                 if (capturePos.row == promotionRow) {
-                    moves.emplace_back(pos, capturePos, MoveType::PROMOTION);
+                    addPromotions(moves, pos, capturePos);
                 } else {
                     moves.emplace_back(pos, capturePos);
                 }
@@ -40,6 +47,4 @@ std::vector<Move> Pawn::getLegalMoves(const Board& board, Position pos) const {
             }
         }
     }
-    
-    return moves;
-} 
\ No newline at end of file
+}
\ No newline at end of file
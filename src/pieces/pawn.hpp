@@ -3,12 +3,7 @@
 
 class Pawn : public Piece {
 public:
-    Pawn(Color c) : Piece(c, PieceType::PAWN) {}
+    constexpr Pawn(Color c) : Piece(c, PieceType::PAWN) {}
     
-    std::vector<Move> getLegalMoves(const Board& board, Position pos) const override;
-    char getSymbol() const override { return isWhite() ? 'P' : 'p'; }
-    int getValue() const override { return 100; }
-    std::unique_ptr<Piece> clone() const override {
-        return std::make_unique<Pawn>(color);
-    }
+    void generateMoves(const Board& board, Position pos, MoveList& moves) const override;
 }; 
\ No newline at end of file
@@ -1,10 +1,19 @@
 #pragma once
+#include "../allocator.hpp"
 #include <vector>
-#include <memory>
 
 enum class Color { WHITE, BLACK };
 enum class PieceType { PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING };
 
+// Material values and FEN symbols, indexed by PieceType (and Color)
+constexpr int PIECE_VALUES[6] = {100, 500, 320, 330, 900, 20000};
+constexpr char PIECE_SYMBOLS[2][6] = {{'P', 'R', 'N', 'B', 'Q', 'K'}, {'p', 'r', 'n', 'b', 'q', 'k'}};
+
+constexpr int pieceValue(PieceType type) { return PIECE_VALUES[static_cast<int>(type)]; }
+constexpr char pieceSymbol(PieceType type, Color color) {
+    return PIECE_SYMBOLS[static_cast<int>(color)][static_cast<int>(type)];
+}
+
 struct Position {
     int row, col;
     Position(int r = 0, int c = 0) : row(r), col(c) {}
@@ -16,19 +25,27 @@ struct Position {
 class Board;
 struct Move;
 
+// Move lists of the search are allocated from the search arena
+using MoveList = std::vector<Move, ArenaAllocator<Move>>;
+
 class Piece {
 protected:
     Color color;
     PieceType type;
     
 public:
-    Piece(Color c, PieceType t) : color(c), type(t) {}
+    constexpr Piece(Color c, PieceType t) : color(c), type(t) {}
     virtual ~Piece() = default;
     
-    virtual std::vector<Move> getLegalMoves(const Board& board, Position pos) const = 0;
-    virtual char getSymbol() const = 0;
-    virtual int getValue() const = 0;
-    virtual std::unique_ptr<Piece> clone() const = 0;
+    // Appends the piece's pseudo-legal moves from `pos`. The board itself
+    // generates moves through the compile-time dispatched MoveGenerator in
+    // movegen.hpp; these are kept on purpose as a second, independent
+    // implementation that MoveGenFuzzer::check (--fuzz) compares it against,
+    // so they must not delegate to MoveGenerator.
+    virtual void generateMoves(const Board& board, Position pos, MoveList& moves) const = 0;
+    
+    char getSymbol() const { return pieceSymbol(type, color); }
+    int getValue() const { return pieceValue(type); }
     
     Color getColor() const { return color; }
     PieceType getType() const { return type; }
@@ -1,9 +1,7 @@
 #include "queen.hpp"
 #include "../board.hpp"
 
-std::vector<Move> Queen::getLegalMoves(const Board& board, Position pos) const {
-    std::vector<Move> moves;
-    
+void Queen::generateMoves(const Board& board, Position pos, MoveList& moves) const {
     int directions[8][2] = {
         {-1, -1}, {-1, 0}, {-1, 1},
         {0, -1},           {0, 1},
@@ -21,7 +19,7 @@ std::vector<Move> Queen::getLegalMoves(const Board& board, Position pos) const {
                 break;
             }
             
-            Piece* target = board.getPiece(newPos);
+            const Piece* target = board.getPiece(newPos);
             if (target == nullptr) {
                 moves.emplace_back(pos, newPos);
             } else {
@@ -32,6 +30,4 @@ std::vector<Move> Queen::getLegalMoves(const Board& board, Position pos) const {
             }
         }
     }
-    
-    return moves;
-} 
\ No newline at end of file
+}
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "player.hpp"
+#include "movepicker.hpp"
+#include "notation.hpp"
+#include "instrument.hpp"
 #include <iostream>
 #include <string>
 #include <algorithm>
-#include <limits>
+#include <cstdlib>
 
 Move HumanPlayer::getMove(const Board& board) {
     std::string input;
@@ -13,50 +16,42 @@ Move HumanPlayer::getMove(const Board& board) {
         exit(0);
     }
     
-    if (input.length() < 4) {
-        throw std::runtime_error("Invalid move format");
+    // Accept coordinate notation (e2e4, e7e8q) as well as SAN (e4, Nf3, O-O)
+    Move move(Position(-1, -1), Position(-1, -1));
+    if (parseMove(input, move) || parseSAN(board, input, move)) {
+        return move;
     }
     
-    Position from, to;
-    
-    if (input[0] >= 'a' && input[0] <= 'h' && input[1] >= '1' && input[1] <= '8') {
-        from = Position(8 - (input[1] - '0'), input[0] - 'a');
-    } else {
-        throw std::runtime_error("Invalid source position");
-    }
-    
-    if (input[2] >= 'a' && input[2] <= 'h' && input[3] >= '1' && input[3] <= '8') {
-        to = Position(8 - (input[3] - '0'), input[2] - 'a');
-    } else {
-        throw std::runtime_error("Invalid destination position");
-    }
-    
-    Move move(from, to);
-    
-    if (input.length() >= 5) {
-        char promotion = input[4];
-        switch (promotion) {
-            case 'q': case 'Q': move.promotionPiece = PieceType::QUEEN; break;
-            case 'r': case 'R': move.promotionPiece = PieceType::ROOK; break;
-            case 'b': case 'B': move.promotionPiece = PieceType::BISHOP; break;
-            case 'n': case 'N': move.promotionPiece = PieceType::KNIGHT; break;
-            default: move.promotionPiece = PieceType::QUEEN; break;
-        }
-        move.type = MoveType::PROMOTION;
-    }
-    
-    return move;
+    throw std::runtime_error("Invalid move format");
+}
+
+// Mate and tablebase scores count plies from the root inside the search, but
+// from the position itself in evaluate(), tablebase probes and the
+// transposition table
+static int relativeToRoot(int score, int ply) {
+    if (score >= WIN_BOUND) return score - ply;
+    if (score <= -WIN_BOUND) return score + ply;
+    return score;
+}
+
+static int relativeToNode(int score, int ply) {
+    if (score >= WIN_BOUND) return score + ply;
+    if (score <= -WIN_BOUND) return score - ply;
+    return score;
 }
 
 int AIPlayer::evaluate(const Board& board) const {
+    INSTRUMENT_SCOPE(EVALUATE);
+    // Scores are kept from White's point of view so that minimax can maximize
+    // for White and minimize for Black regardless of which side the AI plays.
     int score = 0;
     
     for (int i = 0; i < 8; i++) {
         for (int j = 0; j < 8; j++) {
-            Piece* piece = board.getPiece(Position(i, j));
+            const Piece* piece = board.getPiece(Position(i, j));
             if (piece) {
                 int pieceValue = piece->getValue();
-                if (piece->getColor() == color) {
+                if (piece->getColor() == Color::WHITE) {
                     score += pieceValue;
                 } else {
                     score -= pieceValue;
@@ -65,97 +60,474 @@ int AIPlayer::evaluate(const Board& board) const {
         }
     }
     
-    Color opponent = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
-    if (board.isCheckmate(opponent)) {
-        return 1000000;
+    // Mate and stalemate are found by the search, which runs out of moves
+    return score;
+}
+
+int AIPlayer::minimax(Board& board, int depth, int ply, int alpha, int beta, bool maximizing) {
+    INSTRUMENT_SCOPE(SEARCH);
+    nodes++;
+    pvLength[ply] = 0;
+    selDepth = std::max(selDepth, ply);
+    if (nodes % STOP_CHECK_NODES == 0) {
+        stopped = stopRequested.load(std::memory_order_relaxed) || cancellation.isCancelled() ||
+                  (limits.nodes > 0 && nodes >= limits.nodes) ||
+                  (limits.moveTimeMs > 0 && std::chrono::steady_clock::now() >= deadline);
     }
-    if (board.isCheckmate(color)) {
-        return -1000000;
+    if (stopped) return 0;
+    
+    // Cycles and fifty-move positions are draws; the root is never tested,
+    // so a move is still found in them
+    if (board.getGameState().halfmoveClock >= 100 || board.isRepetition()) return 0;
+    
+    TablebaseResult probed;
+    if (tablebase.tables && depth >= tablebase.probeDepth && tablebase.tables->probe(board, probed)) {
+        int score = probed.wdl == 0 ? 0 : probed.wdl * (TABLEBASE_WIN - probed.plies);
+        return relativeToRoot((board.getCurrentPlayer() == Color::WHITE) ? score : -score, ply);
     }
-    if (board.isStalemate(color) || board.isStalemate(opponent)) {
+    
+    if (ply >= MAX_PLY - 1) return evaluate(board);
+    if (depth == 0) return quiescence(board, ply, 0, alpha, beta, maximizing);
+    
+    uint64_t key = board.getKey();
+    uint16_t hashMove = 0;
+    TTEntry entry;
+    if (tt.probe(key, entry)) {
+        hashMove = entry.move;
+        int score = relativeToRoot(entry.score, ply);
+        if (entry.depth >= depth) {
+            if (entry.bound == Bound::EXACT) return score;
+            if (entry.bound == Bound::LOWER && score >= beta) return score;
+            if (entry.bound == Bound::UPPER && score <= alpha) return score;
+        }
+    }
+    
+    // Along the previous iteration's PV its move goes first, elsewhere the
+    // best move of an earlier search of this position
+    uint16_t pvMove = 0;
+    if (followPV && ply < static_cast<int>(previousPV.size())) pvMove = previousPV[ply];
+    MovePicker picker(board, pvMove ? pvMove : hashMove);
+    
+    int originalAlpha = alpha, originalBeta = beta;
+    int bestEval = maximizing ? -INFINITE_SCORE : INFINITE_SCORE;
+    Move bestMove(Position(-1, -1), Position(-1, -1));
+    int legalMoves = 0;
+    
+    Move move(Position(-1, -1), Position(-1, -1));
+    while (picker.next(move)) {
+        // Legality is only tested for the moves that are actually searched
+        if (board.leavesKingInCheck(move)) {
+            INSTRUMENT_COUNT(ILLEGAL_MOVES);
+            continue;
+        }
+        legalMoves++;
+        
+        ArenaMark childMark;
+        board.makeMove(move);
+        followPV = pvMove != 0 && packMove(move) == pvMove;
+        int eval = minimax(board, depth - 1, ply + 1, alpha, beta, !maximizing);
+        board.undoMove();
+        
+        if (maximizing ? eval > bestEval : eval < bestEval) {
+            bestEval = eval;
+            bestMove = move;
+        }
+        if (maximizing && eval > alpha) {
+            alpha = eval;
+            updatePV(ply, move);
+        } else if (!maximizing && eval < beta) {
+            beta = eval;
+            updatePV(ply, move);
+        }
+        if (beta <= alpha) {
+            INSTRUMENT_COUNT(CUTOFFS);
+            break;
+        }
+    }
+    if (stopped) return 0;
+    
+    if (legalMoves == 0) {
+        if (board.isInCheck(board.getCurrentPlayer())) {
+            return maximizing ? -(MATE_SCORE - ply) : MATE_SCORE - ply;
+        }
         return 0;
     }
     
-    return score;
+    Bound bound = Bound::EXACT;
+    if (bestEval <= originalAlpha) bound = Bound::UPPER;
+    else if (bestEval >= originalBeta) bound = Bound::LOWER;
+    tt.store(key, depth, relativeToNode(bestEval, ply), bound, packMove(bestMove));
+    return bestEval;
 }
 
-int AIPlayer::minimax(Board& board, int depth, int alpha, int beta, bool maximizing) const {
-    if (depth == 0) {
-        return evaluate(board);
+// Resolves captures (and, on its first ply, quiet checks) below the nominal
+// depth, so that positions are only evaluated once they are quiet. The side
+// to move may stand pat on the static evaluation unless it is in check, in
+// which case every evasion is searched.
+int AIPlayer::quiescence(Board& board, int ply, int qply, int alpha, int beta, bool maximizing) {
+    INSTRUMENT_SCOPE(QUIESCENCE);
+    nodes++;
+    pvLength[ply] = 0;
+    selDepth = std::max(selDepth, ply);
+    if (nodes % STOP_CHECK_NODES == 0) {
+        stopped = stopRequested.load(std::memory_order_relaxed) || cancellation.isCancelled() ||
+                  (limits.nodes > 0 && nodes >= limits.nodes) ||
+                  (limits.moveTimeMs > 0 && std::chrono::steady_clock::now() >= deadline);
     }
+    if (stopped) return 0;
+    if (ply >= MAX_PLY - 1) return evaluate(board);
     
-    Color currentPlayer = board.getCurrentPlayer();
-    std::vector<Move> moves = board.getLegalMoves(currentPlayer);
-    
-    if (moves.empty()) {
-        if (board.isInCheck(currentPlayer)) {
-            return maximizing ? -1000000 : 1000000;
-        } else {
-            return 0;
-        }
+    bool inCheck = board.isInCheck(board.getCurrentPlayer());
+    int bestEval = maximizing ? -INFINITE_SCORE : INFINITE_SCORE;
+    if (!inCheck) {
+        bestEval = evaluate(board);
+        if (maximizing ? bestEval >= beta : bestEval <= alpha) return bestEval;
+        if (maximizing) alpha = std::max(alpha, bestEval);
+        else beta = std::min(beta, bestEval);
     }
     
-    if (maximizing) {
-        int maxEval = std::numeric_limits<int>::min();
-        for (const auto& move : moves) {
-            Board tempBoard = board;
-            tempBoard.makeMove(move);
-            int eval = minimax(tempBoard, depth - 1, alpha, beta, false);
-            maxEval = std::max(maxEval, eval);
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) {
-                break;
-            }
+    MovePicker picker = MovePicker::quiescence(board, qply == 0);
+    int legalMoves = 0;
+    Move move(Position(-1, -1), Position(-1, -1));
+    while (picker.next(move)) {
+        if (board.leavesKingInCheck(move)) {
+            INSTRUMENT_COUNT(ILLEGAL_MOVES);
+            continue;
         }
-        return maxEval;
-    } else {
-        int minEval = std::numeric_limits<int>::max();
-        for (const auto& move : moves) {
-            Board tempBoard = board;
-            tempBoard.makeMove(move);
-            int eval = minimax(tempBoard, depth - 1, alpha, beta, true);
-            minEval = std::min(minEval, eval);
+        legalMoves++;
+        
+        ArenaMark childMark;
+        board.makeMove(move);
+        int eval = quiescence(board, ply + 1, qply + 1, alpha, beta, !maximizing);
+        board.undoMove();
+        
+        if (maximizing) {
+            bestEval = std::max(bestEval, eval);
+            alpha = std::max(alpha, eval);
+        } else {
+            bestEval = std::min(bestEval, eval);
             beta = std::min(beta, eval);
-            if (beta <= alpha) {
-                break;
-            }
         }
-        return minEval;
+        if (beta <= alpha) {
+            INSTRUMENT_COUNT(CUTOFFS);
+            break;
+        }
     }
+    
+    if (inCheck && legalMoves == 0) return maximizing ? -(MATE_SCORE - ply) : MATE_SCORE - ply;
+    return bestEval;
 }
 
-Move AIPlayer::getMove(const Board& board) {
-    std::cout << (color == Color::WHITE ? "White AI" : "Black AI") << " thinking (depth " << depth << ")...\n";
+void AIPlayer::updatePV(int ply, const Move& move) {
+    pvTable[ply][0] = packMove(move);
+    for (int i = 0; i < pvLength[ply + 1]; i++) pvTable[ply][i + 1] = pvTable[ply + 1][i];
+    pvLength[ply] = pvLength[ply + 1] + 1;
+}
+
+// Searches every root move to rootDepth within the window (alpha, beta),
+// from White's point of view. A score outside the window is only a bound, and
+// the caller searches again with a wider one. Returns false when the limits
+// stopped the pass early; `result` then holds the best of the moves that were
+// searched completely, if any.
+bool AIPlayer::searchRoot(Board& board, MoveList& moves, int rootDepth, int alpha, int beta,
+                          SearchResult& result) {
+    bool maximizing = (board.getCurrentPlayer() == Color::WHITE);
+    size_t bestIndex = 0;
+    int bestScore = maximizing ? -INFINITE_SCORE : INFINITE_SCORE;
+    bool searched = false;
+    
+    for (size_t i = 0; i < moves.size(); i++) {
+        ArenaMark childMark;
+        board.makeMove(moves[i]);
+        followPV = i == 0 && !previousPV.empty() && packMove(moves[0]) == previousPV[0];
+        int score = minimax(board, rootDepth - 1, 1, alpha, beta, !maximizing);
+        board.undoMove();
+        if (stopped) break;
+        
+        if (!searched || (maximizing && score > bestScore) || 
+            (!maximizing && score < bestScore)) {
+            bestScore = score;
+            bestIndex = i;
+            searched = true;
+            rootPV.assign(1, packMove(moves[i]));
+            rootPV.insert(rootPV.end(), pvTable[1], pvTable[1] + pvLength[1]);
+        }
+        if (maximizing) alpha = std::max(alpha, score);
+        else beta = std::min(beta, score);
+        if (alpha >= beta) break;
+    }
     
-    std::vector<Move> legalMoves = board.getLegalMoves(color);
+    if (searched) {
+        result.bestMove = moves[bestIndex];
+        result.score = maximizing ? bestScore : -bestScore;
+    }
+    if (stopped) return false;
     
+    // The next iteration searches this iteration's best move first
+    std::rotate(moves.begin(), moves.begin() + bestIndex, moves.begin() + bestIndex + 1);
+    result.depth = rootDepth;
+    return true;
+}
+
+SearchResult AIPlayer::search(const Board& board) {
+    return search(board, SearchLimits(depth));
+}
+
+SearchResult AIPlayer::search(const Board& board, const SearchLimits& searchLimits) {
+    return search(board, searchLimits, CancellationToken());
+}
+
+SearchResult AIPlayer::search(const Board& board, const SearchLimits& searchLimits, const CancellationToken& token,
+                              ProgressCallback callback) {
+    stopThinking();
+    cancellation = token;
+    progress = std::move(callback);
+    limits = searchLimits;
+    stopRequested = false;
+    depthLimit = std::max(1, limits.depth);
+    SearchResult result = iterate(board);
+    INSTRUMENT_FLUSH();
+    return result;
+}
+
+SearchHandle AIPlayer::searchAsync(const Board& board, const SearchLimits& searchLimits,
+                                  ProgressCallback callback, CancellationToken token) {
+    std::future<SearchResult> future = std::async(std::launch::async,
+        [this, position = Board(board), searchLimits, callback = std::move(callback), token]() mutable {
+            return search(position, searchLimits, token, std::move(callback));
+        });
+    return SearchHandle(std::move(future), token);
+}
+
+// Runs the search set up by the caller: iterative deepening until
+// depthLimit or a stop. Move lists and move scores of the search come from
+// this thread's arena, rewound after every child node; the moves themselves
+// are made and taken back on a single copy of the board.
+SearchResult AIPlayer::iterate(const Board& board) {
+    INSTRUMENT_SCOPE(SEARCH);
+    ArenaScope arenaScope;
+    AllocationStats allocationsBefore = threadAllocationStats();
+    searchStart = std::chrono::steady_clock::now();
+    deadline = searchStart + std::chrono::milliseconds(limits.moveTimeMs);
+    stopped = false;
+    nodes = 0;
+    completedDepth = 0;
+    previousPV.clear();
+    
+    MoveList legalMoves;
+    board.generateLegalMoves(board.getCurrentPlayer(), legalMoves);
     if (legalMoves.empty()) {
         throw std::runtime_error("No legal moves available");
     }
     
-    Move bestMove = legalMoves[0];
-    int bestScore = (color == Color::WHITE) ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+    SearchResult result;
+    result.bestMove = legalMoves[0];
     
-    int moveCount = 0;
-    for (const auto& move : legalMoves) {
-        moveCount++;
-        std::cout << "Evaluating move " << moveCount << "/" << legalMoves.size() << "...\r" << std::flush;
-        
-        Board tempBoard = board;
-        tempBoard.makeMove(move);
+    int lineCount = std::max(1, std::min(limits.multiPV, static_cast<int>(legalMoves.size())));
+    
+    // A root position in the tablebases is answered from them, one line per
+    // ranked move
+    std::vector<TablebaseMove> ranked;
+    if (tablebase.tables && tablebase.tables->probeRoot(board, ranked)) {
+        for (int k = 0; k < lineCount && k < static_cast<int>(ranked.size()); k++) {
+            const TablebaseResult& probed = ranked[k].result;
+            int score = probed.wdl == 0 ? 0 : probed.wdl * (TABLEBASE_WIN - probed.plies);
+            rootPV.assign(1, packMove(ranked[k].move));
+            result.lines.push_back(makeLine(board, score, 0));
+        }
+        result.bestMove = ranked[0].move;
+        result.score = result.lines[0].score;
+        reportProgress(result);
+        return result;
+    }
+    
+    // The one board the search plays its moves on and takes them back
+    Board position(board);
+    for (int d = 1; d <= depthLimit; d++) {
+        SearchResult iteration = result;
+        iteration.lines.clear();
+        selDepth = 0;
         
-        int score = minimax(tempBoard, depth - 1, 
-                           std::numeric_limits<int>::min(), 
-                           std::numeric_limits<int>::max(), 
-                           color == Color::BLACK);
+        // From the second iteration on, the first line is searched in a
+        // narrow window around the previous score, widened on the failing
+        // side whenever the score falls outside it
+        int previous = (board.getCurrentPlayer() == Color::WHITE) ? result.score : -result.score;
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -INFINITE_SCORE, beta = INFINITE_SCORE;
+        if (d > 1 && std::abs(previous) < WIN_BOUND) {
+            alpha = previous - delta;
+            beta = previous + delta;
+        }
+        bool complete;
+        while (true) {
+            complete = searchRoot(position, legalMoves, d, alpha, beta, iteration);
+            int score = (board.getCurrentPlayer() == Color::WHITE) ? iteration.score : -iteration.score;
+            if (!complete || (score > alpha && score < beta)) break;
+            delta *= 2;
+            if (score <= alpha) alpha = (delta < WIN_BOUND) ? std::max(-INFINITE_SCORE, score - delta) : -INFINITE_SCORE;
+            if (score >= beta) beta = (delta < WIN_BOUND) ? std::min(INFINITE_SCORE, score + delta) : INFINITE_SCORE;
+        }
+        std::vector<uint16_t> bestLine = rootPV;
+        if (complete) iteration.lines.push_back(makeLine(board, iteration.score, d));
         
-        if ((color == Color::WHITE && score > bestScore) || 
-            (color == Color::BLACK && score < bestScore)) {
-            bestScore = score;
-            bestMove = move;
+        // Each further line searches the root without the first moves of the
+        // earlier lines; the shared hash table makes these passes cheap
+        for (int k = 1; complete && k < lineCount; k++) {
+            MoveList rest(legalMoves.begin() + k, legalMoves.end());
+            SearchResult line;
+            complete = searchRoot(position, rest, d, -INFINITE_SCORE, INFINITE_SCORE, line);
+            if (complete) {
+                std::move(rest.begin(), rest.end(), legalMoves.begin() + k);
+                iteration.lines.push_back(makeLine(board, line.score, d));
+            }
         }
+        
+        // A partial iteration is only better than nothing
+        if (complete || result.depth == 0) result = iteration;
+        if (!complete) break;
+        completedDepth = d;
+        previousPV = bestLine;
+        
+        result.selDepth = selDepth;
+        result.nodes = nodes;
+        reportProgress(result);
+    }
+    
+    if (result.lines.empty()) {
+        rootPV.assign(1, packMove(result.bestMove));
+        result.lines.push_back(makeLine(board, result.score, result.depth));
+    }
+    result.nodes = nodes;
+    
+    AllocationStats allocationsAfter = threadAllocationStats();
+    searchAllocations.heapAllocations = allocationsAfter.heapAllocations - allocationsBefore.heapAllocations;
+    searchAllocations.arenaPeakBytes = allocationsAfter.arenaPeakBytes;
+    return result;
+}
+
+// Turns rootPV into moves. A line cut short by a hash table cutoff is
+// extended with the hash moves that follow it, each checked for legality.
+SearchLine AIPlayer::makeLine(const Board& board, int score, int lineDepth) const {
+    SearchLine line;
+    line.score = score;
+    line.depth = lineDepth;
+    
+    Board position = board;
+    for (uint16_t code : rootPV) {
+        line.pv.push_back(unpackMove(code));
+        position.makeMove(line.pv.back());
+    }
+    TTEntry entry;
+    while (static_cast<int>(line.pv.size()) < std::max(1, lineDepth) && !position.isRepetition() &&
+           tt.probe(position.getKey(), entry) && entry.move != 0) {
+        if (!position.isLegal(entry.move)) break;
+        line.pv.push_back(unpackMove(entry.move));
+        position.makeMove(line.pv.back());
+    }
+    return line;
+}
+
+void AIPlayer::reportProgress(const SearchResult& result) const {
+    if (!progress) return;
+    SearchProgress update;
+    update.depth = result.depth;
+    update.selDepth = result.selDepth;
+    update.score = result.score;
+    update.bestMove = result.bestMove;
+    update.nodes = nodes;
+    update.timeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - searchStart).count();
+    update.hashfull = tt.hashfull();
+    update.lines = result.lines;
+    progress(update);
+}
+
+bool AIPlayer::probeBook(const Board& board, Move& move) {
+    return book && book->probe(board, bookSelection, rng, move);
+}
+
+void AIPlayer::startPondering(const Board& board, const Move& move) {
+    Board ponderBoard = board;
+    ponderBoard.makeMove(move);
+    
+    // The predicted reply is the hash move of the position after our move;
+    // it is checked for legality since the entry may belong to a collision
+    TTEntry entry;
+    if (!tt.probe(ponderBoard.getKey(), entry) || entry.move == 0 || !ponderBoard.isLegal(entry.move)) return;
+    ponderBoard.makeMove(unpackMove(entry.move));
+    if (!ponderBoard.hasLegalMoves(ponderBoard.getCurrentPlayer())) return;
+    
+    ponderKey = ponderBoard.getKey();
+    cancellation = CancellationToken();
+    progress = nullptr;
+    limits = SearchLimits(MAX_PONDER_DEPTH);
+    stopRequested = false;
+    depthLimit = MAX_PONDER_DEPTH;
+    ponderThread = std::thread([this, ponderBoard = std::move(ponderBoard)]() {
+        ponderResult = iterate(ponderBoard);
+        INSTRUMENT_FLUSH();
+    });
+}
+
+// Ends the ponder search, if any. On a ponder hit the search first finishes
+// the iteration at the normal depth (or stops at once if it got there
+// already) and `result` receives it; a miss is cancelled immediately.
+bool AIPlayer::finishPondering(const Board& board, SearchResult& result) {
+    if (!ponderThread.joinable()) return false;
+    
+    bool hit = board.getKey() == ponderKey;
+    if (hit) {
+        depthLimit = std::max(1, depth);
+        if (completedDepth >= depthLimit) stopRequested = true;
+    } else {
+        stopRequested = true;
+    }
+    ponderThread.join();
+    
+    if (!hit || ponderResult.depth < std::max(1, depth)) return false;
+    result = ponderResult;
+    return true;
+}
+
+void AIPlayer::stopThinking() {
+    if (ponderThread.joinable()) {
+        stopRequested = true;
+        ponderThread.join();
+    }
+}
+
+Move AIPlayer::getMove(const Board& board) {
+    SearchResult result;
+    bool ponderHit = finishPondering(board, result);
+    
+    Move bookMove(Position(-1, -1), Position(-1, -1));
+    if (!ponderHit && probeBook(board, bookMove)) {
+        std::cout << (color == Color::WHITE ? "White AI" : "Black AI") << " plays a book move\n";
+        return bookMove;
+    }
+    
+    if (ponderHit) {
+        std::cout << (color == Color::WHITE ? "White AI" : "Black AI") << " ponder hit (depth "
+                  << result.depth << ")\n";
+    } else {
+        std::cout << (color == Color::WHITE ? "White AI" : "Black AI") << " thinking (depth " << depth << ")...\n";
+        auto report = [](const SearchProgress& update) {
+            std::cout << "  depth " << update.depth << " seldepth " << update.selDepth << " score " << update.score
+                      << " nodes " << update.nodes << " nps " << static_cast<long long>(update.nodesPerSecond())
+                      << " hashfull " << update.hashfull << " pv";
+            for (const auto& move : update.lines[0].pv) std::cout << ' ' << moveToString(move);
+            std::cout << '\n';
+        };
+        result = search(board, SearchLimits(depth), CancellationToken(), report);
     }
     
-    std::cout << "\nMove selected! (Score: " << bestScore << ")\n";
-    return bestMove;
-} 
\ No newline at end of file
+    std::cout << "Move selected! (Score: " << result.score << ", " << result.nodes << " nodes)\n";
+#ifdef DEBUG
+    std::cout << "  allocations: " << searchAllocations.heapAllocations << " heap, arena peak "
+              << searchAllocations.arenaPeakBytes << " bytes\n";
+#endif
+#ifdef INSTRUMENT
+    std::cout << Instrumentation::summary();
+#endif
+    if (ponderEnabled) startPondering(board, result.bestMove);
+    return result.bestMove;
+}
\ No newline at end of file
@@ -1,7 +1,18 @@
 #pragma once
 #include "board.hpp"
 #include "move.hpp"
+#include "book.hpp"
+#include "tablebase.hpp"
+#include "transposition.hpp"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
 
 class Player {
 protected:
@@ -13,6 +24,10 @@ public:
     
     virtual Move getMove(const Board& board) = 0;
     Color getColor() const { return color; }
+    
+    // Called by Game::run once the game is over, so that players thinking
+    // in the background can stop
+    virtual void stopThinking() {}
 };
 
 class HumanPlayer : public Player {
@@ -21,16 +36,221 @@ public:
     Move getMove(const Board& board) override;
 };
 
+// Checkmate at the root. Mates further away score less by their distance
+// in plies from the root, so that shorter mates are preferred.
+static constexpr int MATE_SCORE = 1000000;
+
+// Tablebase wins score below mate and above any material balance; the
+// distance to mate is subtracted in the same way
+static constexpr int TABLEBASE_WIN = 900000;
+
+// Bound beyond every score, used for the full search window; unlike INT_MIN
+// it can be negated safely
+static constexpr int INFINITE_SCORE = MATE_SCORE + 1;
+
+// Scores beyond this are mates or tablebase wins counted from the root; the
+// transposition table stores them counted from the stored position instead
+static constexpr int WIN_BOUND = TABLEBASE_WIN - 1000;
+
+// Half-width of the first aspiration window around the previous score,
+// doubled after every fail-high or fail-low
+static constexpr int ASPIRATION_WINDOW = 50;
+
+// Deepest iteration a ponder search starts
+static constexpr int MAX_PONDER_DEPTH = 64;
+
+// Bound on the distance from the root, sizing the PV table
+static constexpr int MAX_PLY = 128;
+
+// Nodes between checks of the search limits and stop requests
+static constexpr unsigned long long STOP_CHECK_NODES = 1024;
+
+// One analysed line: the score of its first move and the principal
+// variation collected by the search's triangular PV table, extended from the
+// transposition table where a cutoff left it short
+struct SearchLine {
+    int score;                  // side to move's point of view
+    int depth;
+    std::vector<Move> pv;
+    
+    SearchLine() : score(0), depth(0) {}
+};
+
+struct SearchResult {
+    Move bestMove;
+    int score;                  // centipawns from the side to move's point of view
+    int depth;
+    int selDepth;               // deepest ply reached
+    unsigned long long nodes;
+    std::vector<SearchLine> lines;  // best first, SearchLimits::multiPV of them
+    
+    SearchResult() : bestMove(Position(-1, -1), Position(-1, -1)), score(0), depth(0), selDepth(0), nodes(0) {}
+};
+
+// Limits for one search. The search deepens iteratively up to `depth`; when
+// a time or node limit stops it first, the last iteration that finished is
+// returned.
+struct SearchLimits {
+    int depth;
+    int moveTimeMs;             // 0 = no time limit
+    unsigned long long nodes;   // 0 = no node limit
+    int multiPV;                // number of best lines to find
+    
+    SearchLimits(int d = 3, int timeMs = 0, unsigned long long nodeLimit = 0)
+        : depth(d), moveTimeMs(timeMs), nodes(nodeLimit), multiPV(1) {}
+    bool isLimited() const { return moveTimeMs > 0 || nodes > 0; }
+};
+
+// Reported after every completed iteration
+struct SearchProgress {
+    int depth;
+    int selDepth;
+    int score;                  // side to move's point of view
+    Move bestMove;
+    unsigned long long nodes;
+    double timeSeconds;
+    int hashfull;               // transposition table use, per thousand
+    std::vector<SearchLine> lines;
+    
+    SearchProgress() : depth(0), selDepth(0), score(0), bestMove(Position(-1, -1), Position(-1, -1)), nodes(0),
+                       timeSeconds(0), hashfull(0) {}
+    double nodesPerSecond() const { return timeSeconds > 0 ? nodes / timeSeconds : 0; }
+};
+
+using ProgressCallback = std::function<void(const SearchProgress&)>;
+
+// Stop flag shared by all copies of a token. A search polls it every
+// STOP_CHECK_NODES nodes and then returns its best result so far.
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+    
+public:
+    CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+    void cancel() const { flag->store(true); }
+    bool isCancelled() const { return flag->load(std::memory_order_relaxed); }
+};
+
+// A search running on its own thread (see AIPlayer::searchAsync)
+class SearchHandle {
+private:
+    std::future<SearchResult> result;
+    CancellationToken token;
+    
+public:
+    SearchHandle(std::future<SearchResult> future, const CancellationToken& cancellation)
+        : result(std::move(future)), token(cancellation) {}
+    
+    void cancel() const { token.cancel(); }
+    bool isReady() const { return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+    bool waitFor(int milliseconds) const {
+        return result.wait_for(std::chrono::milliseconds(milliseconds)) == std::future_status::ready;
+    }
+    // Waits for the search; rethrows its exception, if any
+    SearchResult get() { return result.get(); }
+};
+
 class AIPlayer : public Player {
 private:
     int depth;
+    unsigned long long nodes;
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point deadline;
+    bool stopped;
+    std::shared_ptr<const OpeningBook> book;
+    BookSelection bookSelection;
+    std::mt19937 rng;
+    TablebaseConfig tablebase;
+    TranspositionTable tt;
     
-    int evaluate(const Board& board) const;
-    int minimax(Board& board, int depth, int alpha, int beta, bool maximizing) const;
+    // Shared with a ponder search running on another thread
+    std::atomic<bool> stopRequested;
+    std::atomic<int> depthLimit;        // no iteration starts beyond this depth
+    std::atomic<int> completedDepth;
+    
+    bool ponderEnabled;
+    std::thread ponderThread;
+    uint64_t ponderKey;                 // position the ponder search expects
+    SearchResult ponderResult;
+    
+    CancellationToken cancellation;
+    ProgressCallback progress;
+    std::chrono::steady_clock::time_point searchStart;
+    
+    // Triangular PV table: row `ply` holds the best line found from that
+    // ply, as packed moves
+    uint16_t pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    std::vector<uint16_t> rootPV;       // line of the last root pass's best move
+    std::vector<uint16_t> previousPV;   // previous iteration's PV, searched first
+    bool followPV;                      // the current node lies on previousPV
+    int selDepth;
+    
+    AllocationStats searchAllocations;
+    
+    int minimax(Board& board, int depth, int ply, int alpha, int beta, bool maximizing);
+    int quiescence(Board& board, int ply, int qply, int alpha, int beta, bool maximizing);
+    void updatePV(int ply, const Move& move);
+    bool searchRoot(Board& board, MoveList& moves, int rootDepth, int alpha, int beta,
+                    SearchResult& result);
+    SearchResult iterate(const Board& board);
+    void reportProgress(const SearchResult& result) const;
+    SearchLine makeLine(const Board& board, int score, int lineDepth) const;
+    
+    void startPondering(const Board& board, const Move& move);
+    bool finishPondering(const Board& board, SearchResult& result);
     
 public:
-    AIPlayer(Color c, int searchDepth = 3) : Player(c), depth(std::min(searchDepth, 3)) {}
+    AIPlayer(Color c, int searchDepth = 3)
+        : Player(c), depth(std::min(searchDepth, 3)), nodes(0), stopped(false),
+          bookSelection(BookSelection::WEIGHTED), rng(std::random_device{}()), stopRequested(false),
+          depthLimit(0), completedDepth(0), ponderEnabled(false), ponderKey(0),
+          pvLength{}, followPV(false), selDepth(0) {}
+    ~AIPlayer() override { stopThinking(); }
     Move getMove(const Board& board) override;
+    void stopThinking() override;
+    SearchResult search(const Board& board);
+    SearchResult search(const Board& board, const SearchLimits& searchLimits);
+    SearchResult search(const Board& board, const SearchLimits& searchLimits, const CancellationToken& token,
+                        ProgressCallback callback = nullptr);
+    
+    // Starts a search on its own thread. The player must stay alive and run
+    // no other search until the handle's result has been collected; servers
+    // use one AIPlayer per concurrent search.
+    SearchHandle searchAsync(const Board& board, const SearchLimits& searchLimits,
+                             ProgressCallback callback = nullptr, CancellationToken token = CancellationToken());
+    
+    // Book moves are played without searching while the position is in book
+    void setBook(std::shared_ptr<const OpeningBook> openingBook, BookSelection selection = BookSelection::WEIGHTED) {
+        book = std::move(openingBook);
+        bookSelection = selection;
+    }
+    bool probeBook(const Board& board, Move& move);
+    
+    // Positions in the tablebases are scored without searching further, and
+    // a root position in them is answered by the tablebase move
+    void setTablebase(const TablebaseConfig& config) { tablebase = config; }
+    
+    // After each move, keep searching the position after the reply the
+    // transposition table predicts until the opponent has moved. If the
+    // prediction was right, getMove() continues from that search.
+    void setPonder(bool enabled) { ponderEnabled = enabled; }
+    
+    // Allocations of this player's last search, on its thread. Heap
+    // allocations are only counted in debug builds.
+    const AllocationStats& lastSearchAllocations() const { return searchAllocations; }
+    
+    // Clearing a new table with several threads spreads its pages over
+    // their NUMA nodes; a table used by one worker is best cleared by it
+    void setHashSize(size_t megabytes, int initThreads = 1) { tt.resize(megabytes, initThreads); }
+    void setHashSize(size_t megabytes, PageMode pages, int initThreads = 1,
+                     ThreadBinding binding = ThreadBinding::NONE) {
+        tt.resize(megabytes, pages, initThreads, binding);
+    }
+    void clearHash() { tt.clear(); }
+    
+    // Static evaluation from White's point of view, in centipawns
+    int evaluate(const Board& board) const;
     
     void setDepth(int newDepth) { depth = newDepth; }
     int getDepth() const { return depth; }
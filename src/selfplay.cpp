@@ -0,0 +1,154 @@
+#include "selfplay.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+
+bool SelfPlayGenerator::loadBook(const std::string& path) {
+    return openings.loadPgn(path, options.bookPlies);
+}
+
+bool SelfPlayGenerator::playGame(unsigned long long index, AIPlayer& searcher, PlayedGame& game) const {
+    std::seed_seq seed{options.seed, static_cast<unsigned int>(index), static_cast<unsigned int>(index >> 32)};
+    std::mt19937 rng(seed);
+    
+    game.positions.clear();
+    game.moves.clear();
+    game.result = GameResult::ONGOING;
+    game.adjudicated = false;
+    game.nodes = 0;
+    searcher.clearHash();
+    
+    // The searched part of the game starts after the opening, so only
+    // engine moves are recorded
+    Board board;
+    if (!openings.generate(rng, options.randomPlies, game.start, board, game.moves)) return false;
+    
+    Board searchBoard;
+    int resignCount = 0, resignSign = 0, drawCount = 0;
+    
+    while (true) {
+        game.result = resultByRule(board);
+        if (game.result != GameResult::ONGOING) break;
+        if (options.tablebase.tables) {
+            game.result = resultByTablebase(*options.tablebase.tables, board);
+            if (game.result != GameResult::ONGOING) {
+                game.adjudicated = true;
+                break;
+            }
+        }
+        if (static_cast<int>(game.moves.size()) >= options.maxPlies) {
+            game.result = GameResult::DRAW;
+            game.adjudicated = true;
+            break;
+        }
+        
+        Color toMove = board.getCurrentPlayer();
+        
+        // Search from the unpacked record: the searcher's copy of the board
+        // then carries only the plies repetition needs, however long the game gets
+        PackedPosition packed = packPosition(board);
+        unpackPosition(packed, searchBoard);
+        searchBoard.copyKeyHistory(board);
+        SearchResult searched = searcher.search(searchBoard);
+        game.nodes += searched.nodes;
+        packed.score = static_cast<int16_t>(std::max(-32000, std::min(32000, searched.score)));
+        game.positions.push_back(packed);
+        
+        int whiteScore = (toMove == Color::WHITE) ? searched.score : -searched.score;
+        if (std::abs(whiteScore) >= options.resignScore) {
+            int sign = whiteScore > 0 ? 1 : -1;
+            resignCount = (sign == resignSign) ? resignCount + 1 : 1;
+            resignSign = sign;
+        } else {
+            resignCount = 0;
+            resignSign = 0;
+        }
+        if (resignCount >= options.resignPlies) {
+            game.result = resignSign > 0 ? GameResult::WHITE_WINS : GameResult::BLACK_WINS;
+            game.adjudicated = true;
+            break;
+        }
+        
+        bool drawish = std::abs(searched.score) <= options.drawScore &&
+                       static_cast<int>(game.moves.size()) >= options.drawAfterPly;
+        drawCount = drawish ? drawCount + 1 : 0;
+        if (drawCount >= options.drawPlies) {
+            game.result = GameResult::DRAW;
+            game.adjudicated = true;
+            break;
+        }
+        
+        Move move = searched.bestMove;
+        board.makeMove(move);
+        game.moves.push_back(std::move(move));
+    }
+    
+    for (auto& position : game.positions) {
+        position.result = static_cast<uint8_t>(game.result);
+    }
+    return true;
+}
+
+SelfPlayStats SelfPlayGenerator::run(PositionWriter& positions, GameWriter* games) {
+    const int numThreads = std::max(1, options.threads);
+    const unsigned long long totalGames = static_cast<unsigned long long>(std::max(0, options.games));
+    
+    std::atomic<unsigned long long> nextGame(0);
+    std::mutex mutex;
+    SelfPlayStats total;
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t]() {
+            Topology::bindThread(t, options.placement.binding);
+            AIPlayer searcher(Color::WHITE);
+            searcher.setHashSize(options.placement.hashMegabytes, options.placement.pages);
+            searcher.setDepth(options.depth);
+            searcher.setTablebase(options.tablebase);
+            PlayedGame game;
+            
+            while (true) {
+                unsigned long long index = nextGame++;
+                if (index >= totalGames) return;
+                
+                // An opening that already ends the game is redrawn with a
+                // different seed, keeping the output deterministic
+                bool played = false;
+                for (int attempt = 0; attempt < 16 && !played; attempt++) {
+                    played = playGame(index + attempt * totalGames, searcher, game);
+                }
+                if (!played) continue;
+                
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const auto& position : game.positions) {
+                    positions.write(position);
+                }
+                if (games) games->write(game.start, game.moves, game.result);
+                
+                total.games++;
+                total.positions += game.positions.size();
+                total.nodes += game.nodes;
+                if (game.adjudicated) total.adjudicated++;
+                switch (game.result) {
+                    case GameResult::WHITE_WINS: total.whiteWins++; break;
+                    case GameResult::BLACK_WINS: total.blackWins++; break;
+                    default: total.draws++; break;
+                }
+            }
+        });
+    }
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    positions.flush();
+    if (games) games->flush();
+    
+    total.timeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
\ No newline at end of file
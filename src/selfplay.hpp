@@ -0,0 +1,77 @@
+#pragma once
+#include "board.hpp"
+#include "game.hpp"
+#include "binary_format.hpp"
+#include "openings.hpp"
+#include "numa.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SelfPlayOptions {
+    int games;
+    int threads;
+    int depth;
+    int randomPlies;            // uniformly random plies played after the book line
+    int bookPlies;              // plies taken from each book game
+    int maxPlies;               // games still running at this length are adjudicated
+    int resignScore;            // |score| at which a game is adjudicated as a win...
+    int resignPlies;            // ...once it has held for this many consecutive plies
+    int drawScore;              // |score| at or below which a game counts as drawish...
+    int drawPlies;              // ...for this many consecutive plies...
+    int drawAfterPly;           // ...after this ply
+    unsigned int seed;
+    TablebaseConfig tablebase;  // also adjudicates games that reach the tables
+    PlacementConfig placement;
+    
+    SelfPlayOptions() : games(100), threads(std::max(1u, std::thread::hardware_concurrency())),
+                        depth(2), randomPlies(8), bookPlies(12), maxPlies(400),
+                        resignScore(1000), resignPlies(6), drawScore(10), drawPlies(20),
+                        drawAfterPly(80), seed(1) {}
+};
+
+struct SelfPlayStats {
+    unsigned long long games;
+    unsigned long long positions;
+    unsigned long long whiteWins;
+    unsigned long long blackWins;
+    unsigned long long draws;
+    unsigned long long adjudicated;
+    unsigned long long nodes;
+    double timeSeconds;
+    
+    SelfPlayStats() : games(0), positions(0), whiteWins(0), blackWins(0), draws(0),
+                      adjudicated(0), nodes(0), timeSeconds(0) {}
+    double gamesPerSecond() const { return timeSeconds > 0 ? games / timeSeconds : 0; }
+    double positionsPerSecond() const { return timeSeconds > 0 ? positions / timeSeconds : 0; }
+};
+
+// Plays engine-vs-engine games concurrently to produce training data. Each
+// worker thread owns one Board and one AIPlayer and plays whole games taken
+// from a shared counter; every searched position is written with its score
+// and, once the game ends, the game result.
+class SelfPlayGenerator {
+private:
+    struct PlayedGame {
+        Board start;
+        std::vector<PackedPosition> positions;
+        std::vector<Move> moves;
+        GameResult result;
+        bool adjudicated;
+        unsigned long long nodes;
+    };
+    
+    SelfPlayOptions options;
+    OpeningSuite openings;
+    
+    bool playGame(unsigned long long index, AIPlayer& searcher, PlayedGame& game) const;
+    
+public:
+    explicit SelfPlayGenerator(const SelfPlayOptions& opts) : options(opts) {}
+    
+    // Loads opening lines from a PGN file (the first bookPlies of each game).
+    bool loadBook(const std::string& path);
+    size_t getBookSize() const { return openings.size(); }
+    
+    SelfPlayStats run(PositionWriter& positions, GameWriter* games = nullptr);
+};
\ No newline at end of file
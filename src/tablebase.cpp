@@ -0,0 +1,824 @@
+#include "tablebase.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+// The files are read as Ronald de Man's probing code and its ports (Fathom,
+// Stockfish) read them. Inside this file squares are numbered a1 = 0 .. h8 =
+// 63, the board's row * 8 + col with the rows reversed, and pieces are the
+// files' 1..6 (pawn, knight, bishop, rook, queen, king) for White and 9..14
+// for Black.
+static const int MAX_TABLE_PIECES = 7;
+static const uint8_t WDL_MAGIC[4] = {0x71, 0xE8, 0x23, 0x5D};
+static const uint8_t DTZ_MAGIC[4] = {0xD7, 0x66, 0x0C, 0xA5};
+
+// Flags of each compressed table
+static const uint8_t FLAG_STM = 1;              // side to move of a one-sided DTZ table
+static const uint8_t FLAG_MAPPED = 2;           // values go through the DTZ value maps
+static const uint8_t FLAG_WIN_PLIES = 4;        // wins counted in plies rather than moves
+static const uint8_t FLAG_LOSS_PLIES = 8;
+static const uint8_t FLAG_WIDE = 16;            // 16-bit value maps
+static const uint8_t FLAG_SINGLE_VALUE = 128;   // every position has the same value
+
+// File piece numbers of the board's piece types (pawn, rook, knight, bishop, queen, king)
+static const int TABLE_PIECES[6] = {1, 4, 2, 3, 5, 6};
+// Order of the pieces in table names
+static const PieceType NAME_ORDER[6] = {PieceType::KING, PieceType::QUEEN, PieceType::ROOK,
+                                        PieceType::BISHOP, PieceType::KNIGHT, PieceType::PAWN};
+
+// Results of the WDL tables, for the side to move: a cursed win is a win
+// the fifty-move rule draws, a blessed loss a loss it saves
+static const int WDL_LOSS = -2;
+static const int WDL_BLESSED_LOSS = -1;
+static const int WDL_CURSED_WIN = 1;
+static const int WDL_WIN = 2;
+
+static int readLittle16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t readLittle32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+static uint32_t readBig32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+static uint64_t readBig64(const uint8_t* p) {
+    return (static_cast<uint64_t>(readBig32(p)) << 32) | readBig32(p + 4);
+}
+
+static int fileOf(int square) { return square & 7; }
+static int rankOf(int square) { return square >> 3; }
+// Negative below the a1-h8 diagonal, positive above it
+static int offDiagonal(int square) { return rankOf(square) - fileOf(square); }
+static int sign(int value) { return (value > 0) - (value < 0); }
+
+// Tables of the position encoding, built once
+struct IndexTables {
+    int mapPawns[64];           // a2..h7 to 47..0, highest nearest the a/h files and rank 2
+    int mapB1H1H7[64];          // squares below the a1-h8 diagonal to 0..27
+    int mapA1D1D4[64];          // the a1-d1-d4 triangle to 0..9, diagonal squares last
+    int mapKK[10][64];          // the 462 placements of two kings, the first in the triangle
+    uint64_t binomial[6][64];   // binomial[k][n] = n choose k
+    int leadPawnIdx[6][64];     // [leading pawns][square of the first one]
+    int leadPawnsSize[6][4];    // [leading pawns][file a..d of the first one]
+    
+    IndexTables();
+};
+
+IndexTables::IndexTables() {
+    int code = 0;
+    for (int square = 0; square < 64; square++) {
+        mapB1H1H7[square] = offDiagonal(square) < 0 ? code++ : -1;
+        mapA1D1D4[square] = -1;
+    }
+    
+    std::vector<int> diagonal;
+    code = 0;
+    for (int square = 0; square < 64; square++) {
+        if (fileOf(square) > 3 || rankOf(square) > 3) continue;
+        if (offDiagonal(square) < 0) mapA1D1D4[square] = code++;
+        else if (offDiagonal(square) == 0) diagonal.push_back(square);
+    }
+    for (int square : diagonal) mapA1D1D4[square] = code++;
+    
+    // With the first king on the diagonal the second one is never above
+    // it; placements with both on the diagonal come last
+    std::vector<std::pair<int, int>> bothOnDiagonal;
+    code = 0;
+    for (int idx = 0; idx < 10; idx++) {
+        int first = static_cast<int>(std::find(mapA1D1D4, mapA1D1D4 + 64, idx) - mapA1D1D4);
+        for (int second = 0; second < 64; second++) {
+            mapKK[idx][second] = -1;
+            if (std::abs(fileOf(first) - fileOf(second)) <= 1 && std::abs(rankOf(first) - rankOf(second)) <= 1) {
+                continue;
+            }
+            if (offDiagonal(first) == 0 && offDiagonal(second) > 0) continue;
+            if (offDiagonal(first) == 0 && offDiagonal(second) == 0) {
+                bothOnDiagonal.emplace_back(idx, second);
+            } else {
+                mapKK[idx][second] = code++;
+            }
+        }
+    }
+    for (const auto& placement : bothOnDiagonal) mapKK[placement.first][placement.second] = code++;
+    
+    for (int k = 0; k < 6; k++) {
+        for (int n = 0; n < 64; n++) {
+            binomial[k][n] = k == 0 ? 1 : n == 0 ? 0 : binomial[k - 1][n - 1] + binomial[k][n - 1];
+        }
+    }
+    
+    // The leading pawn is the one with the highest mapPawns value; the
+    // others can only stand on the squares mapped below it
+    int available = 47;
+    for (int leadPawns = 1; leadPawns <= 5; leadPawns++) {
+        for (int file = 0; file < 4; file++) {
+            int idx = 0;
+            for (int rank = 1; rank <= 6; rank++) {
+                int square = rank * 8 + file;
+                if (leadPawns == 1) {
+                    mapPawns[square] = available--;
+                    mapPawns[square ^ 7] = available--;
+                }
+                leadPawnIdx[leadPawns][square] = idx;
+                idx += static_cast<int>(binomial[leadPawns - 1][mapPawns[square]]);
+            }
+            leadPawnsSize[leadPawns][file] = idx;
+        }
+    }
+}
+
+static const IndexTables& indexTables() {
+    static const IndexTables tables;
+    return tables;
+}
+
+// Material of a table, from its name ("KRPvKR", the stronger side first)
+struct Material {
+    int pieceCount;
+    bool hasPawns;
+    bool hasUniquePieces;       // some side has exactly one piece of a type other than the king
+    bool symmetric;             // both sides have the same pieces
+    int pawnCount[2];           // pawns of the leading side, then of the other
+    
+    Material() : pieceCount(0), hasPawns(false), hasUniquePieces(false), symmetric(false), pawnCount{0, 0} {}
+};
+
+static bool parseMaterial(const std::string& name, Material& material) {
+    size_t separator = name.find('v');
+    if (separator == std::string::npos) return false;
+    
+    std::string sides[2] = {name.substr(0, separator), name.substr(separator + 1)};
+    int pawns[2];
+    material = Material();
+    for (int s = 0; s < 2; s++) {
+        if (sides[s].empty() || sides[s][0] != 'K' || sides[s].find_first_not_of("KQRBNP") != std::string::npos ||
+            std::count(sides[s].begin(), sides[s].end(), 'K') != 1) {
+            return false;
+        }
+        for (char letter : std::string("QRBNP")) {
+            if (std::count(sides[s].begin(), sides[s].end(), letter) == 1) material.hasUniquePieces = true;
+        }
+        pawns[s] = static_cast<int>(std::count(sides[s].begin(), sides[s].end(), 'P'));
+        material.pieceCount += static_cast<int>(sides[s].size());
+    }
+    if (material.pieceCount > MAX_TABLE_PIECES) return false;
+    
+    // The side with fewer pawns leads, since that compresses better
+    material.hasPawns = pawns[0] + pawns[1] > 0;
+    material.symmetric = sides[0] == sides[1];
+    bool strongLeads = pawns[1] == 0 || (pawns[0] > 0 && pawns[1] >= pawns[0]);
+    material.pawnCount[0] = strongLeads ? pawns[0] : pawns[1];
+    material.pawnCount[1] = strongLeads ? pawns[1] : pawns[0];
+    return true;
+}
+
+// Decoding data of one table in a file. WDL files of unequal material hold
+// one for each side to move, files with pawns one for each file (a..d) of
+// the leading pawn.
+struct PairsData {
+    uint8_t flags;
+    uint64_t blockSize;
+    uint64_t span;                  // values between two entries of the sparse index
+    uint32_t numBlocks;
+    int maxSymLen, minSymLen;       // Huffman code lengths; minSymLen is the value of single-value tables
+    const uint8_t* lowestSym;       // lowest symbol of each code length, 16-bit little-endian
+    const uint8_t* btree;           // the two symbols each symbol stands for, 12 bits each
+    const uint8_t* blockLength;     // values in each block minus one, 16-bit little-endian
+    uint32_t blockLengthSize;
+    const uint8_t* sparseIndex;     // block (32 bits) and offset (16 bits) of every span-th value
+    uint64_t sparseIndexSize;
+    const uint8_t* data;            // the compressed blocks
+    std::vector<uint64_t> base64;   // lowest code of each length, left-aligned in 64 bits
+    std::vector<uint8_t> symlen;    // values each symbol stands for, minus one
+    int pieces[MAX_TABLE_PIECES];   // in encoding order
+    uint64_t groupIdx[MAX_TABLE_PIECES + 1];
+    int groupLen[MAX_TABLE_PIECES + 1];    // pieces encoded together, zero-terminated
+    uint16_t mapIdx[4];             // DTZ value maps of wins, losses, cursed wins and blessed losses
+    
+    PairsData() : flags(0), blockSize(0), span(0), numBlocks(0), maxSymLen(0), minSymLen(0), lowestSym(nullptr),
+                  btree(nullptr), blockLength(nullptr), blockLengthSize(0), sparseIndex(nullptr),
+                  sparseIndexSize(0), data(nullptr), pieces{}, groupIdx{}, groupLen{}, mapIdx{} {}
+};
+
+// One .rtbw or .rtbz file, mapped and parsed by the first probe that needs it
+struct TableFile {
+    std::string path;
+    MappedFile file;
+    std::once_flag loaded;
+    bool valid;
+    PairsData items[2][4];          // [side to move][file of the leading pawn]
+    const uint8_t* map;             // DTZ value maps
+    
+    TableFile() : valid(false), map(nullptr) {}
+};
+
+struct Tablebase::Table {
+    Material material;
+    TableFile wdl, dtz;
+};
+
+enum class Tablebase::ProbeState { FAIL, OK, CHANGE_STM, ZEROING_BEST_MOVE };
+
+static int leftSymbol(const PairsData& d, int sym) {
+    const uint8_t* entry = d.btree + 3 * sym;
+    return ((entry[1] & 0xF) << 8) | entry[0];
+}
+
+static int rightSymbol(const PairsData& d, int sym) {
+    const uint8_t* entry = d.btree + 3 * sym;
+    return (entry[2] << 4) | (entry[1] >> 4);
+}
+
+// Pieces of the same type and color are encoded together, except for the
+// leading group: the first three pieces when some piece is unique, else the
+// two kings, or the leading side's pawns. The file gives the order in which
+// the groups multiply into the index.
+static void setGroups(const Material& material, PairsData& d, const int order[2], int file) {
+    const IndexTables& t = indexTables();
+    int n = 0, firstLen = material.hasPawns ? 0 : material.hasUniquePieces ? 3 : 2;
+    d.groupLen[n] = 1;
+    for (int i = 1; i < material.pieceCount; i++) {
+        if (--firstLen > 0 || d.pieces[i] == d.pieces[i - 1]) {
+            d.groupLen[n]++;
+        } else {
+            d.groupLen[++n] = 1;
+        }
+    }
+    d.groupLen[++n] = 0;
+    
+    bool bothPawns = material.hasPawns && material.pawnCount[1] > 0;
+    int next = bothPawns ? 2 : 1;
+    int freeSquares = 64 - d.groupLen[0] - (bothPawns ? d.groupLen[1] : 0);
+    uint64_t idx = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; k++) {
+        if (k == order[0]) {
+            d.groupIdx[0] = idx;
+            idx *= material.hasPawns ? t.leadPawnsSize[d.groupLen[0]][file] : material.hasUniquePieces ? 31332 : 462;
+        } else if (k == order[1]) {
+            d.groupIdx[1] = idx;
+            idx *= t.binomial[d.groupLen[1]][48 - d.groupLen[0]];
+        } else {
+            d.groupIdx[next] = idx;
+            idx *= t.binomial[d.groupLen[next]][freeSquares];
+            freeSquares -= d.groupLen[next++];
+        }
+    }
+    d.groupIdx[n] = idx;
+}
+
+// Symbols stand for pairs of symbols (recursive pairing); a symbol whose
+// right half is 0xFFF is a value
+static uint8_t symbolLength(PairsData& d, int sym, std::vector<bool>& visited) {
+    visited[sym] = true;
+    int right = rightSymbol(d, sym);
+    if (right == 0xFFF) return 0;
+    
+    int left = leftSymbol(d, sym);
+    int count = static_cast<int>(d.symlen.size());
+    if (left >= count || right >= count) return 0;
+    if (!visited[left]) d.symlen[left] = symbolLength(d, left, visited);
+    if (!visited[right]) d.symlen[right] = symbolLength(d, right, visited);
+    return static_cast<uint8_t>(d.symlen[left] + d.symlen[right] + 1);
+}
+
+static const uint8_t* readSizes(PairsData& d, const uint8_t* data) {
+    d.flags = *data++;
+    if (d.flags & FLAG_SINGLE_VALUE) {
+        d.minSymLen = *data++;
+        return data;
+    }
+    
+    uint64_t tableSize = d.groupIdx[std::find(d.groupLen, d.groupLen + MAX_TABLE_PIECES, 0) - d.groupLen];
+    d.blockSize = 1ULL << *data++;
+    d.span = 1ULL << *data++;
+    d.sparseIndexSize = (tableSize + d.span - 1) / d.span;
+    int padding = *data++;
+    d.numBlocks = readLittle32(data);
+    data += 4;
+    d.blockLengthSize = d.numBlocks + padding;
+    d.maxSymLen = *data++;
+    d.minSymLen = *data++;
+    if (d.minSymLen < 1 || d.maxSymLen < d.minSymLen || d.maxSymLen > 32) return nullptr;
+    
+    // Longer codes have lower values, so the lowest code of each length,
+    // left-aligned, decreases with the length: a code's length is the
+    // first whose base64 it is not below
+    d.lowestSym = data;
+    d.base64.assign(d.maxSymLen - d.minSymLen + 1, 0);
+    for (int i = static_cast<int>(d.base64.size()) - 2; i >= 0; i--) {
+        int count = readLittle16(d.lowestSym + 2 * i) - readLittle16(d.lowestSym + 2 * (i + 1));
+        d.base64[i] = (d.base64[i + 1] + count) / 2;
+    }
+    for (size_t i = 0; i < d.base64.size(); i++) d.base64[i] <<= 64 - i - d.minSymLen;
+    data += 2 * d.base64.size();
+    
+    d.symlen.assign(readLittle16(data), 0);
+    data += 2;
+    d.btree = data;
+    std::vector<bool> visited(d.symlen.size());
+    for (size_t sym = 0; sym < d.symlen.size(); sym++) {
+        if (!visited[sym]) d.symlen[sym] = symbolLength(d, static_cast<int>(sym), visited);
+    }
+    return data + 3 * d.symlen.size() + (d.symlen.size() & 1);
+}
+
+// DTZ files map the decompressed values through per-result lists
+static const uint8_t* readDtzMaps(TableFile& table, const uint8_t* data, int files) {
+    table.map = data;
+    for (int f = 0; f < files; f++) {
+        PairsData& d = table.items[0][f];
+        if (!(d.flags & FLAG_MAPPED)) continue;
+        if (d.flags & FLAG_WIDE) {
+            data += reinterpret_cast<uintptr_t>(data) & 1;
+            for (int i = 0; i < 4; i++) {
+                d.mapIdx[i] = static_cast<uint16_t>((data - table.map) / 2 + 1);
+                data += 2 * readLittle16(data) + 2;
+            }
+        } else {
+            for (int i = 0; i < 4; i++) {
+                d.mapIdx[i] = static_cast<uint16_t>(data - table.map + 1);
+                data += *data + 1;
+            }
+        }
+    }
+    return data + (reinterpret_cast<uintptr_t>(data) & 1);
+}
+
+// Layout after the magic: a flags byte, the piece order of every table, the
+// sizes and Huffman codes of every table, the DTZ value maps, the sparse
+// indexes, the block lengths and the 64-byte aligned compressed blocks
+static bool parseTable(const Material& material, TableFile& table, bool dtz) {
+    const uint8_t* start = reinterpret_cast<const uint8_t*>(table.file.data());
+    const uint8_t* end = start + table.file.size();
+    if (table.file.size() < 8 || std::memcmp(start, dtz ? DTZ_MAGIC : WDL_MAGIC, 4) != 0) return false;
+    
+    const uint8_t* data = start + 4;
+    bool split = *data & 1, pawns = *data & 2;
+    if (pawns != material.hasPawns || split == material.symmetric) return false;
+    data++;
+    
+    int sides = (!dtz && !material.symmetric) ? 2 : 1;
+    int files = material.hasPawns ? 4 : 1;
+    bool bothPawns = material.hasPawns && material.pawnCount[1] > 0;
+    for (int f = 0; f < files; f++) {
+        int order[2][2] = {{data[0] & 0xF, bothPawns ? data[1] & 0xF : 0xF},
+                           {data[0] >> 4, bothPawns ? data[1] >> 4 : 0xF}};
+        data += 1 + bothPawns;
+        for (int k = 0; k < material.pieceCount; k++, data++) {
+            for (int i = 0; i < sides; i++) table.items[i][f].pieces[k] = i ? *data >> 4 : *data & 0xF;
+        }
+        for (int i = 0; i < sides; i++) setGroups(material, table.items[i][f], order[i], f);
+    }
+    data += reinterpret_cast<uintptr_t>(data) & 1;
+    
+    for (int f = 0; f < files; f++) {
+        for (int i = 0; i < sides; i++) {
+            data = readSizes(table.items[i][f], data);
+            if (!data || data > end) return false;
+        }
+    }
+    if (dtz) data = readDtzMaps(table, data, files);
+    
+    for (int f = 0; f < files; f++) {
+        for (int i = 0; i < sides; i++) {
+            table.items[i][f].sparseIndex = data;
+            data += 6 * table.items[i][f].sparseIndexSize;
+        }
+    }
+    for (int f = 0; f < files; f++) {
+        for (int i = 0; i < sides; i++) {
+            table.items[i][f].blockLength = data;
+            data += 2 * table.items[i][f].blockLengthSize;
+        }
+    }
+    for (int f = 0; f < files; f++) {
+        for (int i = 0; i < sides; i++) {
+            data = start + ((data - start + 0x3F) & ~0x3F);
+            table.items[i][f].data = data;
+            data += static_cast<uint64_t>(table.items[i][f].numBlocks) * table.items[i][f].blockSize;
+        }
+    }
+    return data <= end;
+}
+
+static bool load(const Material& material, TableFile& table, bool dtz) {
+    std::call_once(table.loaded, [&]() {
+        if (!table.path.empty() && table.file.open(table.path)) {
+            table.valid = parseTable(material, table, dtz);
+            if (!table.valid) table.file.close();
+        }
+    });
+    return table.valid;
+}
+
+// Value number `idx` of a table. The sparse index gives the block and the
+// offset of every span-th value, from which the block holding `idx` is
+// found through the block lengths; the block is then decoded symbol by
+// symbol, and the symbol holding the value split into its pairs.
+static int decompress(const PairsData& d, uint64_t idx) {
+    if (d.flags & FLAG_SINGLE_VALUE) return d.minSymLen;
+    
+    const uint8_t* entry = d.sparseIndex + 6 * (idx / d.span);
+    uint32_t block = readLittle32(entry);
+    int offset = readLittle16(entry + 4) + static_cast<int>(idx % d.span) - static_cast<int>(d.span / 2);
+    while (offset < 0) offset += readLittle16(d.blockLength + 2 * --block) + 1;
+    while (offset > readLittle16(d.blockLength + 2 * block)) offset -= readLittle16(d.blockLength + 2 * block++) + 1;
+    
+    const uint8_t* ptr = d.data + static_cast<uint64_t>(block) * d.blockSize;
+    uint64_t buf64 = readBig64(ptr);
+    ptr += 8;
+    int buf64Size = 64;
+    uint16_t sym;
+    while (true) {
+        int len = 0;
+        while (buf64 < d.base64[len]) len++;
+        sym = static_cast<uint16_t>((buf64 - d.base64[len]) >> (64 - len - d.minSymLen));
+        sym = static_cast<uint16_t>(sym + readLittle16(d.lowestSym + 2 * len));
+        if (offset < d.symlen[sym] + 1) break;
+        
+        offset -= d.symlen[sym] + 1;
+        len += d.minSymLen;
+        buf64 <<= len;
+        buf64Size -= len;
+        if (buf64Size <= 32) {
+            buf64Size += 32;
+            buf64 |= static_cast<uint64_t>(readBig32(ptr)) << (64 - buf64Size);
+            ptr += 4;
+        }
+    }
+    
+    while (d.symlen[sym]) {
+        int left = leftSymbol(d, sym);
+        if (offset < d.symlen[left] + 1) {
+            sym = static_cast<uint16_t>(left);
+        } else {
+            offset -= d.symlen[left] + 1;
+            sym = static_cast<uint16_t>(rightSymbol(d, sym));
+        }
+    }
+    return leftSymbol(d, sym);
+}
+
+// A decompressed DTZ value as plies to zeroing, for the result `wdl`
+static int mapDtz(const TableFile& table, int file, int value, int wdl) {
+    static const int WDL_MAP[5] = {1, 3, 0, 2, 0};
+    const PairsData& d = table.items[0][file];
+    if (d.flags & FLAG_MAPPED) {
+        int position = d.mapIdx[WDL_MAP[wdl + 2]] + value;
+        value = (d.flags & FLAG_WIDE) ? readLittle16(table.map + 2 * position) : table.map[position];
+    }
+    if ((wdl == WDL_WIN && !(d.flags & FLAG_WIN_PLIES)) || (wdl == WDL_LOSS && !(d.flags & FLAG_LOSS_PLIES)) ||
+        wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS) {
+        value *= 2;
+    }
+    return value + 1;
+}
+
+// Position of the board in a loaded file: the table and the index in it.
+// The tables have the stronger side, or for equal material the side to
+// move, as White; other positions are looked up with colors and ranks
+// swapped. Null for a DTZ file that only holds the other side to move.
+static const PairsData* encode(const Material& material, const TableFile& table, bool dtz, const Board& board,
+                               bool blackStronger, uint64_t& idx, int& file) {
+    const IndexTables& t = indexTables();
+    int sideToMove = board.getCurrentPlayer() == Color::WHITE ? 0 : 1;
+    bool flip = blackStronger || (material.symmetric && sideToMove == 1);
+    int flipColor = flip ? 8 : 0, flipSquares = flip ? 56 : 0;
+    int stm = (flip ? 1 : 0) ^ sideToMove;
+    
+    int boardSquares[MAX_TABLE_PIECES], boardPieces[MAX_TABLE_PIECES], count = 0;
+    for (int square = 0; square < 64 && count < MAX_TABLE_PIECES; square++) {
+        uint8_t code = board.getSnapshot().squares[square ^ 56];
+        if (code == NO_PIECE) continue;
+        boardSquares[count] = square ^ flipSquares;
+        int piece = TABLE_PIECES[static_cast<int>(codeType(code))] + (codeColor(code) == Color::BLACK ? 8 : 0);
+        boardPieces[count++] = piece ^ flipColor;
+    }
+    
+    int squares[MAX_TABLE_PIECES], pieces[MAX_TABLE_PIECES];
+    int size = 0, leadPawns = 0;
+    file = 0;
+    auto byMapPawns = [&t](int a, int b) { return t.mapPawns[a] < t.mapPawns[b]; };
+    
+    // Tables with pawns are split by the file of the leading pawn, the one
+    // nearest the a/h files and then nearest the leading side's second rank
+    if (material.hasPawns) {
+        int leadPiece = table.items[0][0].pieces[0];
+        for (int i = 0; i < count; i++) {
+            if (boardPieces[i] == leadPiece) squares[size++] = boardSquares[i];
+        }
+        leadPawns = size;
+        std::swap(squares[0], *std::max_element(squares, squares + leadPawns, byMapPawns));
+        file = fileOf(squares[0]) > 3 ? fileOf(squares[0] ^ 7) : fileOf(squares[0]);
+    }
+    
+    if (dtz && (table.items[0][file].flags & FLAG_STM) != stm && !(material.symmetric && !material.hasPawns)) {
+        return nullptr;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (material.hasPawns && boardPieces[i] == table.items[0][0].pieces[0]) continue;
+        squares[size] = boardSquares[i];
+        pieces[size++] = boardPieces[i];
+    }
+    const PairsData& d = table.items[dtz ? 0 : stm][file];
+    
+    // Put the pieces in the table's order
+    for (int i = leadPawns; i < size - 1; i++) {
+        for (int j = i + 1; j < size; j++) {
+            if (d.pieces[i] == pieces[j]) {
+                std::swap(pieces[i], pieces[j]);
+                std::swap(squares[i], squares[j]);
+                break;
+            }
+        }
+    }
+    
+    // Mirror the board so that the first piece is on files a..d
+    if (fileOf(squares[0]) > 3) {
+        for (int i = 0; i < size; i++) squares[i] ^= 7;
+    }
+    
+    if (material.hasPawns) {
+        idx = t.leadPawnIdx[leadPawns][squares[0]];
+        std::stable_sort(squares + 1, squares + leadPawns, byMapPawns);
+        for (int i = 1; i < leadPawns; i++) idx += t.binomial[i][t.mapPawns[squares[i]]];
+    } else {
+        // Without pawns the first piece is also brought to ranks 1..4, and
+        // the first piece of the leading group off the a1-h8 diagonal below it
+        if (rankOf(squares[0]) > 3) {
+            for (int i = 0; i < size; i++) squares[i] ^= 56;
+        }
+        for (int i = 0; i < d.groupLen[0]; i++) {
+            if (!offDiagonal(squares[i])) continue;
+            if (offDiagonal(squares[i]) > 0) {
+                for (int j = i; j < size; j++) squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+            }
+            break;
+        }
+        
+        if (material.hasUniquePieces) {
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (offDiagonal(squares[0])) {
+                idx = (t.mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+            } else if (offDiagonal(squares[1])) {
+                idx = (6 * 63 + rankOf(squares[0]) * 28 + t.mapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+            } else if (offDiagonal(squares[2])) {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + rankOf(squares[0]) * 7 * 28 + (rankOf(squares[1]) - adjust1) * 28 +
+                      t.mapB1H1H7[squares[2]];
+            } else {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rankOf(squares[0]) * 7 * 6 +
+                      (rankOf(squares[1]) - adjust1) * 6 + (rankOf(squares[2]) - adjust2);
+            }
+        } else {
+            idx = t.mapKK[t.mapA1D1D4[squares[0]]][squares[1]];
+        }
+    }
+    
+    // The other groups, each as a combination of the squares the earlier
+    // groups leave free; the other side's pawns only use ranks 2..7
+    idx *= d.groupIdx[0];
+    int* groupSquares = squares + d.groupLen[0];
+    bool remainingPawns = material.hasPawns && material.pawnCount[1] > 0;
+    for (int next = 1; d.groupLen[next]; next++) {
+        std::stable_sort(groupSquares, groupSquares + d.groupLen[next]);
+        uint64_t n = 0;
+        for (int i = 0; i < d.groupLen[next]; i++) {
+            auto earlier = [&](int square) { return groupSquares[i] > square; };
+            int adjust = static_cast<int>(std::count_if(squares, groupSquares, earlier));
+            n += t.binomial[i + 1][groupSquares[i] - adjust - 8 * remainingPawns];
+        }
+        remainingPawns = false;
+        idx += n * d.groupIdx[next];
+        groupSquares += d.groupLen[next];
+    }
+    return &d;
+}
+
+// A result reached by a zeroing move, as the DTZ of the move
+static int dtzBeforeZeroing(int wdl) {
+    return wdl == WDL_WIN ? 1 : wdl == WDL_CURSED_WIN ? 101 : wdl == WDL_BLESSED_LOSS ? -101 : wdl == WDL_LOSS ? -1 : 0;
+}
+
+static bool isCapture(const Board& board, const Move& move) {
+    return move.type == MoveType::EN_PASSANT || board.getPieceCode(move.to.row, move.to.col) != NO_PIECE;
+}
+
+static bool isPawnMove(const Board& board, const Move& move) {
+    return codeType(board.getPieceCode(move.from.row, move.from.col)) == PieceType::PAWN;
+}
+
+static bool hasCastlingRights(const Board& board) {
+    const GameState& state = board.getGameState();
+    return state.whiteCanCastleKingside || state.whiteCanCastleQueenside || state.blackCanCastleKingside ||
+           state.blackCanCastleQueenside;
+}
+
+static int countPieces(const Board& board) {
+    const auto& squares = board.getSnapshot().squares;
+    return static_cast<int>(64 - std::count(squares.begin(), squares.end(), NO_PIECE));
+}
+
+Tablebase::Tablebase(const std::string& paths) : largest(0) {
+    // A table found in several directories is read from the first one
+    std::map<std::string, std::string> found[2];
+    std::stringstream list(paths);
+    std::string directory;
+    while (std::getline(list, directory, ':')) {
+        if (directory.empty()) continue;
+        std::error_code error;
+        for (auto entry = std::filesystem::directory_iterator(directory, error);
+             !error && entry != std::filesystem::directory_iterator(); entry.increment(error)) {
+            std::string extension = entry->path().extension().string();
+            if (extension == ".rtbw" || extension == ".rtbz") {
+                found[extension == ".rtbz"].emplace(entry->path().stem().string(), entry->path().string());
+            }
+        }
+    }
+    
+    for (const auto& wdl : found[0]) {
+        Material material;
+        if (!parseMaterial(wdl.first, material)) continue;
+        auto table = std::make_unique<Table>();
+        table->material = material;
+        table->wdl.path = wdl.second;
+        auto dtz = found[1].find(wdl.first);
+        if (dtz != found[1].end()) table->dtz.path = dtz->second;
+        largest = std::max(largest, material.pieceCount);
+        tables.emplace(wdl.first, std::move(table));
+    }
+}
+
+Tablebase::~Tablebase() = default;
+
+Tablebase::Table* Tablebase::find(const Board& board, bool& blackStronger) const {
+    const auto& squares = board.getSnapshot().squares;
+    std::string sides[2];
+    for (PieceType type : NAME_ORDER) {
+        for (int c = 0; c < 2; c++) {
+            Color color = c == 0 ? Color::WHITE : Color::BLACK;
+            auto count = std::count(squares.begin(), squares.end(), pieceCode(type, color));
+            sides[c].append(count, pieceSymbol(type, Color::WHITE));
+        }
+    }
+    
+    auto table = tables.find(sides[0] + "v" + sides[1]);
+    blackStronger = table == tables.end();
+    if (blackStronger) table = tables.find(sides[1] + "v" + sides[0]);
+    return table == tables.end() ? nullptr : table->second.get();
+}
+
+int Tablebase::probeTable(const Board& board, bool dtz, int wdl, ProbeState& state) const {
+    if (countPieces(board) == 2) return 0;
+    
+    bool blackStronger;
+    Table* table = find(board, blackStronger);
+    if (!table || !load(table->material, dtz ? table->dtz : table->wdl, dtz)) {
+        state = ProbeState::FAIL;
+        return 0;
+    }
+    TableFile& file = dtz ? table->dtz : table->wdl;
+    
+    uint64_t idx;
+    int pawnFile;
+    const PairsData* d = encode(table->material, file, dtz, board, blackStronger, idx, pawnFile);
+    if (!d) {
+        state = ProbeState::CHANGE_STM;
+        return 0;
+    }
+    int value = decompress(*d, idx);
+    return dtz ? mapDtz(file, pawnFile, value, wdl) : value - 2;
+}
+
+// The tables may store any value for positions where a capture (or, with
+// `zeroingMoves`, a pawn move) wins, and a loss where one draws, whichever
+// compresses better; so those moves are searched, recursively, and the
+// best of them and the table value is the result
+int Tablebase::searchWDL(Board& board, bool zeroingMoves, ProbeState& state) const {
+    int bestValue = WDL_LOSS;
+    std::vector<Move> moves = board.getLegalMoves(board.getCurrentPlayer());
+    size_t searched = 0;
+    for (const Move& move : moves) {
+        if (!isCapture(board, move) && (!zeroingMoves || !isPawnMove(board, move))) continue;
+        searched++;
+        
+        board.makeMove(move);
+        int value = -searchWDL(board, false, state);
+        board.undoMove();
+        if (state == ProbeState::FAIL) return 0;
+        
+        if (value > bestValue) {
+            bestValue = value;
+            if (value >= WDL_WIN) {
+                state = ProbeState::ZEROING_BEST_MOVE;
+                return value;
+            }
+        }
+    }
+    
+    // With every legal move searched the table is not needed, and may be
+    // wrong: it knows nothing of en passant
+    bool noMoreMoves = searched > 0 && searched == moves.size();
+    int value = bestValue;
+    if (!noMoreMoves) {
+        value = probeTable(board, false, 0, state);
+        if (state == ProbeState::FAIL) return 0;
+    }
+    
+    if (bestValue >= value) {
+        state = (bestValue > 0 || noMoreMoves) ? ProbeState::ZEROING_BEST_MOVE : ProbeState::OK;
+        return bestValue;
+    }
+    state = ProbeState::OK;
+    return value;
+}
+
+// Signed plies to zeroing, 100 more for cursed wins and blessed losses
+int Tablebase::probeDTZ(Board& board, ProbeState& state) const {
+    state = ProbeState::OK;
+    int wdl = searchWDL(board, true, state);
+    if (state == ProbeState::FAIL || wdl == 0) return 0;
+    if (state == ProbeState::ZEROING_BEST_MOVE) return dtzBeforeZeroing(wdl);
+    
+    int dtz = probeTable(board, true, wdl, state);
+    if (state == ProbeState::FAIL) return 0;
+    if (state != ProbeState::CHANGE_STM) {
+        return (dtz + (wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS ? 100 : 0)) * sign(wdl);
+    }
+    
+    // The file holds the other side to move: take the best move's DTZ
+    int best = 0xFFFF;
+    for (const Move& move : board.getLegalMoves(board.getCurrentPlayer())) {
+        bool zeroing = isCapture(board, move) || isPawnMove(board, move);
+        board.makeMove(move);
+        dtz = zeroing ? -dtzBeforeZeroing(searchWDL(board, false, state)) : -probeDTZ(board, state);
+        
+        Color opponent = board.getCurrentPlayer();
+        if (dtz == 1 && board.isInCheck(opponent) && !board.hasLegalMoves(opponent)) best = 1;
+        if (!zeroing) dtz += sign(dtz);
+        if (dtz < best && sign(dtz) == sign(wdl)) best = dtz;
+        board.undoMove();
+        if (state == ProbeState::FAIL) return 0;
+    }
+    return best == 0xFFFF ? -1 : best;
+}
+
+bool Tablebase::probe(const Board& board, TablebaseResult& result) const {
+    if (board.getGameState().halfmoveClock != 0 || hasCastlingRights(board) || countPieces(board) > largest) {
+        return false;
+    }
+    
+    Board position(board.getSnapshot());
+    ProbeState state = ProbeState::OK;
+    int wdl = searchWDL(position, false, state);
+    if (state == ProbeState::FAIL) return false;
+    
+    result = TablebaseResult();
+    result.wdl = wdl == WDL_WIN ? 1 : wdl == WDL_LOSS ? -1 : 0;
+    return true;
+}
+
+bool Tablebase::probeRoot(const Board& board, std::vector<TablebaseMove>& moves) const {
+    if (hasCastlingRights(board) || countPieces(board) > largest) return false;
+    
+    int clock = board.getGameState().halfmoveClock;
+    Board position(board.getSnapshot());
+    std::vector<std::pair<int, TablebaseMove>> ranked;
+    for (const Move& move : position.getLegalMoves(position.getCurrentPlayer())) {
+        position.makeMove(move);
+        ProbeState state = ProbeState::OK;
+        int dtz;
+        if (position.getGameState().halfmoveClock == 0) {
+            dtz = dtzBeforeZeroing(-searchWDL(position, false, state));
+        } else {
+            dtz = -probeDTZ(position, state);
+            dtz += sign(dtz);
+        }
+        Color opponent = position.getCurrentPlayer();
+        if (dtz == 2 && position.isInCheck(opponent) && !position.hasLegalMoves(opponent)) dtz = 1;
+        position.undoMove();
+        if (state == ProbeState::FAIL) return false;
+        
+        // A result is only kept if it zeroes before the fifty-move rule
+        // draws the game; wins it draws still rank above draws, losses it
+        // saves below them
+        TablebaseResult result;
+        bool decided = std::abs(dtz) + clock <= 100;
+        result.wdl = decided ? sign(dtz) : 0;
+        result.plies = decided ? std::abs(dtz) : 0;
+        int rank = dtz > 0 ? (decided ? 2000000 : 1000000) - dtz : dtz < 0 ? (decided ? -2000000 : -1000000) - dtz : 0;
+        ranked.emplace_back(rank, TablebaseMove(move, result));
+    }
+    
+    std::stable_sort(ranked.begin(), ranked.end(), [](const std::pair<int, TablebaseMove>& a,
+                                                      const std::pair<int, TablebaseMove>& b) {
+        return a.first > b.first;
+    });
+    moves.clear();
+    for (const auto& entry : ranked) moves.push_back(entry.second);
+    return !moves.empty();
+}
\ No newline at end of file
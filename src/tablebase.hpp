@@ -0,0 +1,68 @@
+#pragma once
+#include "board.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TablebaseResult {
+    int wdl;        // 1 = win, 0 = draw, -1 = loss for the side to move, under the fifty-move rule
+    int plies;      // distance to zeroing (the next capture or pawn move) in plies, 0 if not probed
+    
+    TablebaseResult() : wdl(0), plies(0) {}
+};
+
+struct TablebaseMove {
+    Move move;
+    TablebaseResult result;     // for the side playing the move, counting the move itself
+    
+    TablebaseMove(const Move& m, const TablebaseResult& r) : move(m), result(r) {}
+};
+
+// Syzygy endgame tablebases: the .rtbw (win/draw/loss) and .rtbz (distance
+// to zeroing) files of one or more directories. Only the names are read when
+// the tablebases are opened; each file is memory-mapped the first time a
+// probe needs it. Positions with castling rights are never in the tables.
+class Tablebase {
+private:
+    struct Table;
+    enum class ProbeState;
+    
+    std::unordered_map<std::string, std::unique_ptr<Table>> tables;    // by material, "KRPvKR"
+    int largest;
+    
+    Table* find(const Board& board, bool& blackStronger) const;
+    int probeTable(const Board& board, bool dtz, int wdl, ProbeState& state) const;
+    int searchWDL(Board& board, bool zeroingMoves, ProbeState& state) const;
+    int probeDTZ(Board& board, ProbeState& state) const;
+    
+public:
+    // `paths` lists directories separated by ':'
+    explicit Tablebase(const std::string& paths);
+    ~Tablebase();
+    
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+    
+    // Number of WDL tables found, and the most pieces any of them has
+    int available() const { return static_cast<int>(tables.size()); }
+    int maxPieces() const { return largest; }
+    
+    // Win, draw or loss from the WDL tables. Wins and losses the fifty-move
+    // rule turns into draws count as draws, with the halfmove clock at zero:
+    // positions with a running clock are not probed.
+    bool probe(const Board& board, TablebaseResult& result) const;
+    
+    // Every legal move with its result from the DTZ tables, best first:
+    // wins that zero soonest, then draws, then losses that zero last. The
+    // halfmove clock decides which results the fifty-move rule draws. False
+    // if the position or a DTZ table it needs is not available.
+    bool probeRoot(const Board& board, std::vector<TablebaseMove>& moves) const;
+};
+
+struct TablebaseConfig {
+    std::shared_ptr<const Tablebase> tables;
+    int probeDepth;             // minimum remaining depth for probes inside the search
+    
+    TablebaseConfig() : probeDepth(1) {}
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "transposition.hpp"
+#include "instrument.hpp"
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+void TranspositionTable::resize(size_t megabytes, int threads) {
+    resize(megabytes, pages, threads);
+}
+
+void TranspositionTable::resize(size_t megabytes, PageMode pageMode, int threads, ThreadBinding binding) {
+    size_t newCount = 1;
+    while (newCount * 2 * sizeof(TTEntry) <= std::max<size_t>(1, megabytes) << 20) newCount *= 2;
+    
+    entries = nullptr;
+    count = mask = 0;
+    pages = pageMode;
+    if (!memory.allocate(newCount * sizeof(TTEntry), pages)) throw std::bad_alloc();
+    entries = static_cast<TTEntry*>(memory.data());
+    count = newCount;
+    mask = count - 1;
+    clear(threads, binding);
+}
+
+void TranspositionTable::clear(int threads, ThreadBinding binding) {
+    // TTEntry is trivially destructible, so constructing over old entries is
+    // fine and also starts the lifetime of the new table's
+    size_t slices = std::max(1, std::min(threads, static_cast<int>(count >> 16)));
+    if (slices <= 1) {
+        std::uninitialized_fill(entries, entries + count, TTEntry());
+        return;
+    }
+    
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < slices; i++) {
+        workers.emplace_back([this, i, slices, binding]() {
+            Topology::bindThread(static_cast<int>(i), binding);
+            std::uninitialized_fill(entries + count * i / slices, entries + count * (i + 1) / slices, TTEntry());
+        });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    INSTRUMENT_SCOPE(TT_PROBE);
+    const TTEntry& slot = entries[key & mask];
+    if (slot.bound == Bound::NONE || slot.key != key) {
+        INSTRUMENT_COUNT(TT_MISSES);
+        return false;
+    }
+    INSTRUMENT_COUNT(TT_HITS);
+    entry = slot;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, Bound bound, uint16_t move) {
+    INSTRUMENT_SCOPE(TT_STORE);
+    TTEntry& slot = entries[key & mask];
+    if (slot.bound != Bound::NONE && slot.key == key && slot.depth > depth) return;
+    
+    // Keep the old best move when the new search found none
+    if (move == 0 && slot.key == key) move = slot.move;
+    slot.key = key;
+    slot.score = score;
+    slot.move = move;
+    slot.depth = static_cast<int8_t>(depth);
+    slot.bound = bound;
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = std::min<size_t>(1000, count);
+    size_t used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        if (entries[i].bound != Bound::NONE) used++;
+    }
+    return static_cast<int>(used * 1000 / sample);
+}
\ No newline at end of file
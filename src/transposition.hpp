@@ -0,0 +1,62 @@
+#pragma once
+#include "numa.hpp"
+#include <cstddef>
+#include <cstdint>
+
+enum class Bound : uint8_t { NONE, UPPER, LOWER, EXACT };
+
+// One 16-byte slot. Scores are from White's point of view, with mate and
+// tablebase scores counted from this position rather than from the root;
+// `move` uses the packMove() encoding, 0 for none.
+struct TTEntry {
+    uint64_t key;
+    int32_t score;
+    uint16_t move;
+    int8_t depth;
+    Bound bound;
+    
+    TTEntry() : key(0), score(0), move(0), depth(0), bound(Bound::NONE) {}
+};
+
+// Hash table of search results keyed by Zobrist key, one entry per slot.
+// A slot is overwritten by a different position, or by the same position
+// searched at least as deep. The slots live in a LargePageBuffer, in huge
+// pages by default.
+class TranspositionTable {
+private:
+    LargePageBuffer memory;
+    TTEntry* entries;
+    size_t count;
+    size_t mask;
+    PageMode pages;
+    
+public:
+    explicit TranspositionTable(size_t megabytes = 4, PageMode pageMode = PageMode::TRANSPARENT)
+        : entries(nullptr), count(0), mask(0), pages(pageMode) { resize(megabytes); }
+    
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+    
+    // Rounds down to a power-of-two number of entries and clears the table.
+    // Throws std::bad_alloc if the memory cannot be mapped.
+    void resize(size_t megabytes, int threads = 1);
+    void resize(size_t megabytes, PageMode pageMode, int threads = 1,
+                ThreadBinding binding = ThreadBinding::NONE);
+    
+    // With several threads each clears one slice, thread i bound as worker
+    // i. Clearing a new table is its first touch, so the slices' pages land
+    // on the NUMA nodes of the threads that cleared them.
+    void clear(int threads = 1, ThreadBinding binding = ThreadBinding::NONE);
+    
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, int depth, int score, Bound bound, uint16_t move);
+    
+    size_t size() const { return count; }
+    
+    // Backing actually obtained, and how much of it is in huge pages now
+    PageMode getPageMode() const { return memory.getBacking(); }
+    size_t hugePageBytes() const { return memory.hugePageBytes(); }
+    
+    // Used entries per thousand, sampled from the start of the table
+    int hashfull() const;
+};
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include "board.hpp"
+#include <cstdint>
+#include <string>
+
+// Zobrist keys in the Polyglot layout: 768 piece-square keys indexed by
+// 64 * kind + 8 * rank + file (kind = 2 * piece + 1 for White, pawns first,
+// rank 0 = first rank), 4 castling keys (K, Q, k, q), 8 en passant file keys
+// and one key for White to move.
+//
+// The built-in table is Polyglot's published Random64 table, so keys and
+// books match those of other Polyglot tools. loadKeys() replaces it with 781
+// hexadecimal values read from a text file.
+class Zobrist {
+public:
+    static constexpr int KEY_COUNT = 781;
+    static constexpr int CASTLE_OFFSET = 768;
+    static constexpr int EN_PASSANT_OFFSET = 772;
+    static constexpr int TURN_OFFSET = 780;
+    
+    // Replaces the key table; call before any keys are computed
+    static bool loadKeys(const std::string& path);
+    
+    static uint64_t pieceKey(PieceType type, Color color, const Position& pos);
+    static uint64_t castleKey(int index) { return table()[CASTLE_OFFSET + index]; }
+    static uint64_t enPassantKey(int file) { return table()[EN_PASSANT_OFFSET + file]; }
+    static uint64_t turnKey() { return table()[TURN_OFFSET]; }
+    
+    // Castling, en passant and side-to-move part of the key
+    static uint64_t stateKey(const Board& board);
+    
+    // Full key of a position, computed from scratch (Board::getKey() keeps
+    // the piece part incrementally). As in Polyglot, the en passant file only
+    // counts when a pawn of the side to move can actually capture there.
+    static uint64_t hash(const Board& board);
+    
+private:
+    static uint64_t* table();
+};
\ No newline at end of file